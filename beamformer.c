@@ -2,19 +2,12 @@
 /* TODO(rnp):
  * [ ]: measure performance of doing channel mapping in a separate shader
  * [ ]: BeamformWorkQueue -> BeamformerWorkQueue
- * [ ]: need to keep track of gpu memory in some way
- *      - want to be able to store more than 16 2D frames but limit 3D frames
- *      - maybe keep track of how much gpu memory is committed for beamformed images
- *        and use that to determine when to loop back over existing textures
- *      - to do this maybe use a circular linked list instead of a flat array
- *      - then have a way of querying how many frames are available for a specific point count
  * [ ]: bug: reinit cuda on hot-reload
  */
 
 #include "beamformer.h"
 
 global f32 dt_for_frame;
-global u32 cycle_t;
 
 #ifndef _DEBUG
 #define start_renderdoc_capture(...)
@@ -26,13 +19,125 @@ global renderdoc_end_frame_capture_fn   *end_frame_capture;
 #define end_renderdoc_capture(gl)   if (end_frame_capture)   end_frame_capture(gl, 0)
 #endif
 
-typedef struct {
-	BeamformerFrame *frames;
-	u32 capacity;
-	u32 offset;
-	u32 cursor;
-	u32 needed_frames;
-} ComputeFrameIterator;
+/* NOTE(rnp): eight classes per power of two; at most 1/8 of a buffer is wasted */
+function u64
+beamformer_buffer_pool_size_class(u64 size)
+{
+	u64 step = BEAMFORMER_BUFFER_POOL_MIN_SIZE;
+	while (step * 8 < size) step <<= 1;
+	u64 result = (u64)round_up_to((iz)MAX(size, BEAMFORMER_BUFFER_POOL_MIN_SIZE), (iz)step);
+	return result;
+}
+
+function BeamformerPooledBuffer
+beamformer_buffer_pool_acquire(BeamformerBufferPool *bp, u64 size, s8 label)
+{
+	BeamformerPooledBuffer result = {.size = beamformer_buffer_pool_size_class(size)};
+	for (u32 i = 0; i < bp->free_count; i++) {
+		if (bp->free_buffers[i].size == result.size) {
+			result.buffer      = bp->free_buffers[i].buffer;
+			bp->free_buffers[i] = bp->free_buffers[--bp->free_count];
+			bp->free_bytes     -= result.size;
+			break;
+		}
+	}
+
+	if (!result.buffer) {
+		glCreateBuffers(1, &result.buffer);
+		glNamedBufferStorage(result.buffer, (iz)result.size, 0, 0);
+		bp->allocated_bytes += result.size;
+		bp->allocated_count++;
+	}
+	LABEL_GL_OBJECT(GL_BUFFER, result.buffer, label);
+
+	return result;
+}
+
+function void
+beamformer_buffer_pool_release(BeamformerBufferPool *bp, BeamformerPooledBuffer *b)
+{
+	if (b->buffer) {
+		if (bp->free_count == countof(bp->free_buffers)) {
+			/* NOTE(rnp): pool is full; drop the largest idle buffer */
+			u32 largest = 0;
+			for (u32 i = 1; i < bp->free_count; i++)
+				if (bp->free_buffers[i].size > bp->free_buffers[largest].size)
+					largest = i;
+			BeamformerPooledBuffer *drop = bp->free_buffers + largest;
+			glDeleteBuffers(1, &drop->buffer);
+			bp->allocated_bytes -= drop->size;
+			bp->free_bytes      -= drop->size;
+			bp->allocated_count--;
+			*drop = bp->free_buffers[--bp->free_count];
+		}
+		bp->free_buffers[bp->free_count++] = *b;
+		bp->free_bytes += b->size;
+	}
+	zero_struct(b);
+}
+
+function BeamformerComputeWorker *
+beamformer_compute_worker_for_block(BeamformerComputeContext *cc, u32 block)
+{
+	BeamformerComputeWorker *result = cc->workers + block % MAX(1, cc->worker_count);
+	return result;
+}
+
+/* NOTE(rnp): deletes retired fences which have signalled and which no reader can still be
+ * using. with force set it waits for all of them */
+function void
+beamformer_frame_syncs_collect(BeamformerComputeWorker *worker, b32 force)
+{
+	u32 kept = 0;
+	for (u32 i = 0; i < worker->retired_sync_count; i++) {
+		GLsync           sync  = worker->retired_syncs[i];
+		BeamformerFrame *frame = worker->retired_sync_frames[i];
+		if (force) {
+			spin_wait(atomic_load_u32(&frame->sync_readers));
+			glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		}
+		if (atomic_load_u32(&frame->sync_readers) == 0 && glClientWaitSync(sync, 0, 0) != GL_TIMEOUT_EXPIRED) {
+			glDeleteSync(sync);
+		} else {
+			worker->retired_syncs[kept]       = sync;
+			worker->retired_sync_frames[kept] = frame;
+			kept++;
+		}
+	}
+	worker->retired_sync_count = kept;
+}
+
+/* NOTE(rnp): replaces the frame's fence. a reader may have loaded the old one just before
+ * the swap so it is only deleted later by beamformer_frame_syncs_collect() */
+function void
+beamformer_frame_replace_sync(BeamformerComputeWorker *worker, BeamformerFrame *frame, GLsync sync)
+{
+	GLsync old = (GLsync)atomic_swap_u64((u64 *)&frame->sync, (u64)sync);
+	if (old) {
+		beamformer_frame_syncs_collect(worker, worker->retired_sync_count == countof(worker->retired_syncs));
+		u32 index = worker->retired_sync_count++;
+		worker->retired_syncs[index]       = old;
+		worker->retired_sync_frames[index] = frame;
+	}
+}
+
+function void
+beamformer_frame_fence(BeamformerComputeWorker *worker, BeamformerFrame *frame)
+{
+	beamformer_frame_replace_sync(worker, frame, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+/* NOTE(rnp): orders this context's following commands after the frame's writes without
+ * stalling the CPU. if the fence was replaced in the meantime the newer one also covers the
+ * older writes since both come from the same context */
+function void
+beamformer_frame_wait(BeamformerFrame *frame)
+{
+	atomic_add_u32(&frame->sync_readers, 1);
+	GLsync sync = (GLsync)atomic_load_u64((u64 *)&frame->sync);
+	if (sync) glWaitSync(sync, 0, GL_TIMEOUT_IGNORED);
+	atomic_add_u32(&frame->sync_readers, (u32)-1);
+}
 
 function void
 beamformer_compute_plan_release(BeamformerComputeContext *cc, u32 block)
@@ -40,6 +145,16 @@ beamformer_compute_plan_release(BeamformerComputeContext *cc, u32 block)
 	assert(block < countof(cc->compute_plans));
 	BeamformerComputePlan *cp = cc->compute_plans[block];
 	if (cp) {
+		BeamformerComputeWorker *worker = beamformer_compute_worker_for_block(cc, block);
+		for EachElement(cp->interstage_buffers, it)
+			beamformer_buffer_pool_release(&worker->interstage_pool, cp->interstage_buffers + it);
+		for EachElement(cp->averaged_frames, it) {
+			glDeleteTextures(1, &cp->averaged_frames[it].texture);
+			beamformer_frame_replace_sync(worker, cp->averaged_frames + it, 0);
+		}
+		/* NOTE(rnp): the plan goes back on the freelist; nothing may still reference its frames */
+		beamformer_frame_syncs_collect(worker, 1);
+		glDeleteTextures(1, &cp->average_accumulator.frame.texture);
 		glDeleteBuffers(countof(cp->ubos), cp->ubos);
 		glDeleteTextures(countof(cp->textures), cp->textures);
 		for (u32 i = 0; i < countof(cp->filters); i++)
@@ -148,35 +263,51 @@ beamformer_filter_update(BeamformerFilter *f, BeamformerFilterKind kind,
 	glObjectLabel(GL_TEXTURE, f->texture, (i32)label.len, (c8 *)label.data);
 }
 
-function ComputeFrameIterator
-compute_frame_iterator(BeamformerCtx *ctx, u32 start_index, u32 needed_frames)
+function b32
+beamformer_frame_compatible(BeamformerFrame *f, iv3 dim, GLenum gl_kind)
 {
-	start_index = start_index % ARRAY_COUNT(ctx->beamform_frames);
+	b32 result = gl_kind == f->gl_kind && iv3_equal(dim, f->dim);
+	return result;
+}
 
-	ComputeFrameIterator result;
-	result.frames        = ctx->beamform_frames;
-	result.offset        = start_index;
-	result.capacity      = ARRAY_COUNT(ctx->beamform_frames);
-	result.cursor        = 0;
-	result.needed_frames = needed_frames;
+function GLenum
+gl_kind_from_output_data_kind(BeamformerDataKind kind)
+{
+	GLenum result;
+	switch (kind) {
+	case BeamformerDataKind_Float16:{        result = GL_R16F;  }break;
+	case BeamformerDataKind_Float16Complex:{ result = GL_RG16F; }break;
+	case BeamformerDataKind_Float32Complex:{ result = GL_RG32F; }break;
+	default:{                                result = GL_R32F;  }break;
+	}
 	return result;
 }
 
-function BeamformerFrame *
-frame_next(ComputeFrameIterator *bfi)
+function BeamformerDataKind
+output_data_kind_from_gl_kind(GLenum gl_kind)
 {
-	BeamformerFrame *result = 0;
-	if (bfi->cursor != bfi->needed_frames) {
-		u32 index = (bfi->offset + bfi->cursor++) % bfi->capacity;
-		result    = bfi->frames + index;
+	BeamformerDataKind result;
+	switch (gl_kind) {
+	case GL_R16F:{  result = BeamformerDataKind_Float16;        }break;
+	case GL_RG16F:{ result = BeamformerDataKind_Float16Complex; }break;
+	case GL_RG32F:{ result = BeamformerDataKind_Float32Complex; }break;
+	default:{       result = BeamformerDataKind_Float32;        }break;
 	}
 	return result;
 }
 
-function b32
-beamformer_frame_compatible(BeamformerFrame *f, iv3 dim, GLenum gl_kind)
+/* NOTE(rnp): returns the size of a single voxel and the matching pixel transfer
+ * format/type for reading back a frame's texture without conversion */
+function u32
+gl_kind_pixel_format(GLenum gl_kind, GLenum *format, GLenum *type)
 {
-	b32 result = gl_kind == f->gl_kind && iv3_equal(dim, f->dim);
+	u32 result;
+	switch (gl_kind) {
+	case GL_R16F:{  result = 2; *format = GL_RED; *type = GL_HALF_FLOAT; }break;
+	case GL_RG16F:{ result = 4; *format = GL_RG;  *type = GL_HALF_FLOAT; }break;
+	case GL_RG32F:{ result = 8; *format = GL_RG;  *type = GL_FLOAT;      }break;
+	default:{       result = 4; *format = GL_RED; *type = GL_FLOAT;      }break;
+	}
 	return result;
 }
 
@@ -216,6 +347,135 @@ alloc_beamform_frame(GLParams *gp, BeamformerFrame *out, iv3 out_dim, GLenum gl_
 	LABEL_GL_OBJECT(GL_TEXTURE, out->texture, stream_to_s8(&label));
 }
 
+/* NOTE(rnp): size of the texture including its full mip chain */
+function u64
+beamformer_frame_bytes(iv3 dim, GLenum gl_kind)
+{
+	GLenum format, type;
+	u64 voxel_size = gl_kind_pixel_format(gl_kind, &format, &type);
+
+	iv3 level_dim = {{MAX(1, dim.x), MAX(1, dim.y), MAX(1, dim.z)}};
+	u64 result = 0;
+	for (;;) {
+		result += (u64)level_dim.x * (u64)level_dim.y * (u64)level_dim.z * voxel_size;
+		if (level_dim.x == 1 && level_dim.y == 1 && level_dim.z == 1)
+			break;
+		level_dim.x = MAX(1, level_dim.x >> 1);
+		level_dim.y = MAX(1, level_dim.y >> 1);
+		level_dim.z = MAX(1, level_dim.z >> 1);
+	}
+	return result;
+}
+
+function void
+beamformer_frame_cache_lock(BeamformerFrameCache *fc)
+{
+	for (u32 expected = 0; !atomic_cas_u32(&fc->lock, &expected, 1); expected = 0);
+}
+
+function void
+beamformer_frame_cache_unlock(BeamformerFrameCache *fc)
+{
+	atomic_store_u32(&fc->lock, 0);
+}
+
+function void
+beamformer_frame_unpin(BeamformerFrameCache *fc, BeamformerFrame *frame)
+{
+	beamformer_frame_cache_lock(fc);
+	frame->pins--;
+	beamformer_frame_cache_unlock(fc);
+}
+
+/* NOTE(rnp): points *slot at frame, moving the pin from the old frame. the cache lock must be held */
+function void
+beamformer_frame_repin(BeamformerFrame **slot, BeamformerFrame *frame)
+{
+	if (*slot) (*slot)->pins--;
+	if (frame) frame->pins++;
+	*slot = frame;
+}
+
+function void
+beamformer_frame_cache_release(BeamformerFrameCache *fc, BeamformerComputeWorker *worker, BeamformerFrame *frame)
+{
+	assert(frame->texture);
+	fc->committed_bytes -= beamformer_frame_bytes(frame->dim, frame->gl_kind);
+	fc->frame_count--;
+	/* NOTE(rnp): the slot stays valid for anyone still holding a pointer to it */
+	glDeleteTextures(1, &frame->texture);
+	beamformer_frame_replace_sync(worker, frame, 0);
+	frame->texture          = 0;
+	frame->ready_to_present = 0;
+}
+
+function BeamformerFrame *
+beamformer_frame_cache_acquire(BeamformerFrameCache *fc, BeamformerComputeWorker *worker, GLParams *gl,
+                               iv3 dim, GLenum gl_kind,
+                               u32 id, Arena arena)
+{
+	beamformer_frame_cache_lock(fc);
+
+	BeamformerFrame *free_slot = 0, *oldest = 0, *oldest_compatible = 0;
+	for EachElement(fc->frames, it) {
+		BeamformerFrame *f = fc->frames + it;
+		if (!f->texture) {
+			if (!free_slot) free_slot = f;
+			continue;
+		}
+		/* NOTE(rnp): another worker is still writing this one or someone is displaying it */
+		if (!atomic_load_u32(&f->ready_to_present) || f->pins)
+			continue;
+		/* NOTE(rnp): ids increase monotonically (modulo wrap around) */
+		if (!oldest || id - f->id > id - oldest->id)
+			oldest = f;
+		if (beamformer_frame_compatible(f, dim, gl_kind) &&
+		    (!oldest_compatible || id - f->id > id - oldest_compatible->id))
+		{
+			oldest_compatible = f;
+		}
+	}
+
+	u64 needed_bytes = beamformer_frame_bytes(dim, gl_kind);
+	b32 fits         = fc->committed_bytes + needed_bytes <= fc->budget;
+
+	BeamformerFrame *result;
+	if (free_slot && (fits || fc->frame_count == 0)) {
+		result = free_slot;
+	} else if (oldest_compatible) {
+		result = oldest_compatible;
+	} else {
+		/* NOTE(rnp): always leave room for at least the frame being requested */
+		result = free_slot;
+		while (oldest && (!result || fc->committed_bytes + needed_bytes > fc->budget)) {
+			beamformer_frame_cache_release(fc, worker, oldest);
+			result = oldest;
+			oldest = 0;
+			for EachElement(fc->frames, it) {
+				BeamformerFrame *f = fc->frames + it;
+				if (f->texture && f->ready_to_present && !f->pins && (!oldest || id - f->id > id - oldest->id))
+					oldest = f;
+			}
+		}
+	}
+	/* NOTE(rnp): only possible if every slot is in flight on some worker or pinned */
+	assert(result);
+
+	/* NOTE(rnp): a reused slot may still be sampled by the context that presented it */
+	if (result->texture) beamformer_frame_wait(result);
+	result->id               = id;
+	result->ready_to_present = 0;
+	if (!result->texture) {
+		alloc_beamform_frame(gl, result, dim, gl_kind, s8("Beamformed_Data"), arena);
+		fc->committed_bytes += beamformer_frame_bytes(result->dim, result->gl_kind);
+		fc->frame_count++;
+	}
+
+	beamformer_frame_cache_unlock(fc);
+
+	return result;
+}
+
 function void
 update_hadamard_texture(BeamformerComputePlan *cp, i32 order, Arena arena)
 {
@@ -236,24 +496,27 @@ update_hadamard_texture(BeamformerComputePlan *cp, i32 order, Arena arena)
 }
 
 function void
-alloc_shader_storage(BeamformerCtx *ctx, u32 decoded_data_size, Arena arena)
+alloc_shader_storage(BeamformerCtx *ctx, BeamformerComputeWorker *worker, BeamformerComputePlan *cp,
+                     u32 block, Arena arena)
 {
 	BeamformerComputeContext *cc = &ctx->compute_context;
-	glDeleteBuffers(countof(cc->ping_pong_ssbos), cc->ping_pong_ssbos);
-	glCreateBuffers(countof(cc->ping_pong_ssbos), cc->ping_pong_ssbos);
-
-	cc->ping_pong_ssbo_size = decoded_data_size;
+	BeamformerBufferPool     *bp = &worker->interstage_pool;
 
 	Stream label = arena_stream(arena);
-	stream_append_s8(&label, s8("PingPongSSBO["));
+	stream_append_s8(&label, s8("Interstage["));
+	stream_append_u64(&label, block);
+	stream_append_s8(&label, s8("]["));
 	i32 s_widx = label.widx;
-	for (i32 i = 0; i < countof(cc->ping_pong_ssbos); i++) {
-		glNamedBufferStorage(cc->ping_pong_ssbos[i], (iz)decoded_data_size, 0, 0);
-		stream_append_i64(&label, i);
+
+	for EachElement(cp->interstage_buffers, it) {
+		stream_append_u64(&label, it);
 		stream_append_byte(&label, ']');
-		LABEL_GL_OBJECT(GL_BUFFER, cc->ping_pong_ssbos[i], stream_to_s8(&label));
+		beamformer_buffer_pool_release(bp, cp->interstage_buffers + it);
+		cp->interstage_buffers[it] = beamformer_buffer_pool_acquire(bp, cp->rf_size, stream_to_s8(&label));
 		stream_reset(&label, s_widx);
 	}
+	/* NOTE(rnp): buffer names may be reused after a release so force a new registration */
+	zero_struct(&cc->cuda_registered_buffers);
 
 	/* TODO(rnp): (25.08.04) cuda lib is heavily broken atm. First there are multiple RF
 	 * buffers and cuda decode shouldn't assume that the data is coming from the rf_buffer
@@ -261,18 +524,139 @@ alloc_shader_storage(BeamformerCtx *ctx, u32 decoded_data_size, Arena arena)
 	 * decode should just take the texture as a parameter. Third, none of these dimensions
 	 * need to be pre-known by the library unless its allocating GPU memory which it shouldn't
 	 * need to do. For now grab out of parameter block 0 but it is not correct */
-	BeamformerParameterBlock *pb = beamformer_parameter_block(ctx->shared_memory.region, 0);
+	BeamformerSharedMemory   *sm = ctx->shared_memory.region;
+	BeamformerParameterBlock *pb = sm->published_parameter_blocks + 0;
 	/* NOTE(rnp): these are stubs when CUDA isn't supported */
-	cuda_register_buffers(cc->ping_pong_ssbos, countof(cc->ping_pong_ssbos), cc->rf_buffer.ssbo);
 	u32 decoded_data_dimension[3] = {pb->parameters.sample_count, pb->parameters.channel_count, pb->parameters.acquisition_count};
 	cuda_init(pb->parameters.raw_data_dimensions, decoded_data_dimension);
 }
 
+function void
+cuda_register_plan_buffers(BeamformerComputeContext *cc, BeamformerComputePlan *cp)
+{
+	u32 buffers[countof(cp->interstage_buffers)];
+	b32 changed = cc->cuda_registered_rf_ssbo != cc->rf_buffer.ssbo;
+	for EachElement(cp->interstage_buffers, it) {
+		buffers[it] = cp->interstage_buffers[it].buffer;
+		changed |= buffers[it] != cc->cuda_registered_buffers[it];
+	}
+	if (changed) {
+		cuda_register_buffers(buffers, countof(buffers), cc->rf_buffer.ssbo);
+		mem_copy(cc->cuda_registered_buffers, buffers, sizeof(buffers));
+		cc->cuda_registered_rf_ssbo = cc->rf_buffer.ssbo;
+	}
+}
+
+function BeamformerDispatchPacer
+beamformer_dispatch_pacer_begin(u64 dispatch_time_ns)
+{
+	BeamformerDispatchPacer result = {0};
+	/* NOTE(rnp): two in flight keeps the GPU busy while the CPU waits on the older one.
+	 * this is also used until a dispatch has been measured */
+	result.allowed_in_flight = 2;
+	if (dispatch_time_ns > 0) {
+		u64 allowed = BEAMFORMER_DISPATCH_BUDGET_NS / dispatch_time_ns;
+		result.allowed_in_flight = (u32)CLAMP(allowed, 2, BEAMFORMER_MAX_DISPATCHES_IN_FLIGHT);
+	}
+	return result;
+}
+
+function void
+beamformer_dispatch_pacer_wait(BeamformerDispatchPacer *dp)
+{
+	if (dp->submitted >= dp->allowed_in_flight) {
+		u32 index = (dp->submitted - dp->allowed_in_flight) % countof(dp->syncs);
+		while (glClientWaitSync(dp->syncs[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(dp->syncs[index]);
+		dp->syncs[index] = 0;
+	}
+}
+
+function void
+beamformer_dispatch_pacer_submit(BeamformerDispatchPacer *dp)
+{
+	/* IMPORTANT(rnp): each dispatch must end up in its own submission otherwise the OS
+	 * may coalesce them and kill our shader */
+	dp->syncs[dp->submitted++ % countof(dp->syncs)] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+}
+
+function void
+beamformer_dispatch_pacer_end(BeamformerDispatchPacer *dp)
+{
+	for EachElement(dp->syncs, it)
+		if (dp->syncs[it]) glDeleteSync(dp->syncs[it]);
+}
+
+/* NOTE(rnp): the whole group is reserved at once so that groups pushed by different
+ * threads never interleave */
+function void
+push_compute_timing_infos(ComputeTimingTable *t, ComputeTimingInfo *infos, u32 count)
+{
+	u32 index = atomic_add_u32(&t->write_index, count);
+	for (u32 i = 0; i < count; i++)
+		t->buffer[(index + i) % countof(t->buffer)] = infos[i];
+}
+
 function void
 push_compute_timing_info(ComputeTimingTable *t, ComputeTimingInfo info)
 {
-	u32 index = atomic_add_u32(&t->write_index, 1) % countof(t->buffer);
-	t->buffer[index] = info;
+	push_compute_timing_infos(t, &info, 1);
+}
+
+/* NOTE(rnp): pushes the timings of every frame whose queries have completed. queries
+ * complete in submission order so only the last query in each set needs to be checked.
+ * if wait is set this blocks until all outstanding queries are available */
+function void
+beamformer_collect_timer_queries(BeamformerComputeContext *cc, BeamformerComputeWorker *worker,
+                                 ComputeTimingTable *t, b32 wait)
+{
+	while (worker->timer_query_read_index != worker->timer_query_write_index) {
+		u32 index = worker->timer_query_read_index % countof(worker->timer_query_sets);
+		BeamformerTimerQuerySet *qs = worker->timer_query_sets + index;
+		if (!wait && qs->shader_count > 0) {
+			u32 available = 0;
+			glGetQueryObjectuiv(qs->queries[qs->shader_count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) break;
+		}
+
+		ComputeTimingInfo infos[BeamformerMaxComputeShaderStages + 2] = {0};
+		u32 info_count = 0;
+		infos[info_count++].kind = ComputeTimingInfoKind_ComputeFrameBegin;
+		for (u32 i = 0; i < qs->shader_count; i++) {
+			ComputeTimingInfo *info = infos + info_count++;
+			info->kind   = ComputeTimingInfoKind_Shader;
+			info->shader = qs->shaders[i];
+			glGetQueryObjectui64v(qs->queries[i], GL_QUERY_RESULT, &info->timer_count);
+
+			BeamformerComputePlan *cp = cc->compute_plans[qs->parameter_block];
+			if (info->shader == BeamformerShaderKind_DAS && cp && cp->das_dispatch_count)
+				cp->das_dispatch_time_ns = info->timer_count / cp->das_dispatch_count;
+		}
+		infos[info_count++].kind = ComputeTimingInfoKind_ComputeFrameEnd;
+		push_compute_timing_infos(t, infos, info_count);
+
+		worker->timer_query_read_index++;
+	}
+}
+
+function void
+beamformer_collect_timestamp_queries(BeamformerRFBuffer *rf, ComputeTimingTable *t, b32 wait)
+{
+	while (rf->data_timestamp_read_index != rf->data_timestamp_write_index) {
+		u32 query = rf->data_timestamp_queries[rf->data_timestamp_read_index % countof(rf->data_timestamp_queries)];
+		if (!wait) {
+			u32 available = 0;
+			glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) break;
+		}
+
+		ComputeTimingInfo info = {.kind = ComputeTimingInfoKind_RF_Data};
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &info.timer_count);
+		push_compute_timing_info(t, info);
+
+		rf->data_timestamp_read_index++;
+	}
 }
 
 function b32
@@ -282,31 +666,30 @@ fill_frame_compute_work(BeamformerCtx *ctx, BeamformWork *work, BeamformerViewPl
 	b32 result = 0;
 	if (work) {
 		result = 1;
-		u32 frame_id    = atomic_add_u32(&ctx->next_render_frame_index, 1);
-		u32 frame_index = frame_id % countof(ctx->beamform_frames);
-		work->kind      = indirect? BeamformerWorkKind_ComputeIndirect : BeamformerWorkKind_Compute;
-		work->lock      = BeamformerSharedMemoryLockKind_DispatchCompute;
-		work->compute_context.parameter_block = parameter_block;
-		work->compute_context.frame = ctx->beamform_frames + frame_index;
-		work->compute_context.frame->ready_to_present = 0;
-		work->compute_context.frame->view_plane_tag   = plane;
-		work->compute_context.frame->id               = frame_id;
+		work->kind = indirect? BeamformerWorkKind_ComputeIndirect : BeamformerWorkKind_Compute;
+		work->lock = BeamformerSharedMemoryLockKind_DispatchCompute;
+		/* NOTE(rnp): the frame itself is acquired by the compute thread once the output
+		 * dimensions are known */
+		work->compute_context.frame_id        = atomic_add_u32(&ctx->next_render_frame_index, 1);
+		work->compute_context.parameter_block = (u8)parameter_block;
+		work->compute_context.view_plane      = (u8)plane;
 	}
 	return result;
 }
 
 function void
-do_sum_shader(BeamformerComputeContext *cc, u32 *in_textures, u32 in_texture_count, f32 in_scale,
-              u32 out_texture, iv3 out_data_dim)
+do_sum_shader(u32 program, u32 *in_textures, u32 in_texture_count, f32 in_scale,
+              u32 out_texture, iv3 out_data_dim, GLenum gl_kind)
 {
 	/* NOTE: zero output before summing */
 	glClearTexImage(out_texture, 0, GL_RED, GL_FLOAT, 0);
 	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
 
-	glBindImageTexture(0, out_texture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RG32F);
-	glProgramUniform1f(cc->programs[BeamformerShaderKind_Sum], SUM_PRESCALE_UNIFORM_LOC, in_scale);
+	glBindImageTexture(0, out_texture, 0, GL_TRUE, 0, GL_READ_WRITE, gl_kind);
+	glProgramUniform1f(program, SUM_PRESCALE_UNIFORM_LOC, in_scale);
+	glProgramUniform1i(program, SUM_MODE_UNIFORM_LOC,     BeamformerSumMode_Full);
 	for (u32 i = 0; i < in_texture_count; i++) {
-		glBindImageTexture(1, in_textures[i], 0, GL_TRUE, 0, GL_READ_ONLY, GL_RG32F);
+		glBindImageTexture(1, in_textures[i], 0, GL_TRUE, 0, GL_READ_ONLY, gl_kind);
 		glDispatchCompute(ORONE((u32)out_data_dim.x / 32u),
 		                  ORONE((u32)out_data_dim.y),
 		                  ORONE((u32)out_data_dim.z / 32u));
@@ -314,6 +697,94 @@ do_sum_shader(BeamformerComputeContext *cc, u32 *in_textures, u32 in_texture_cou
 	}
 }
 
+/* NOTE(rnp): records frame as summed into the accumulator's window */
+function void
+beamformer_average_accumulator_push(BeamformerAverageAccumulator *acc, BeamformerFrame *frame)
+{
+	u32 index = acc->summed_frame_count++ % countof(acc->summed_frames);
+	acc->summed_frames[index]    = frame;
+	acc->summed_frame_ids[index] = frame->id;
+}
+
+/* NOTE(rnp): the frame summed in `back` frames before the newest one, if its slot still holds
+ * it. it is pinned so no other worker can reuse it before the sum reading it is dispatched.
+ * the frame cache lock must be held */
+function BeamformerFrame *
+beamformer_average_accumulator_pin(BeamformerAverageAccumulator *acc, u32 back, BeamformerFrame *frame)
+{
+	BeamformerFrame *result = 0;
+	if (back < acc->summed_frame_count && back < countof(acc->summed_frames)) {
+		u32 index = (acc->summed_frame_count - 1 - back) % countof(acc->summed_frames);
+		BeamformerFrame *f = acc->summed_frames[index];
+		if (f->texture && f->id == acc->summed_frame_ids[index] &&
+		    beamformer_frame_compatible(f, frame->dim, frame->gl_kind))
+		{
+			f->pins++;
+			result = f;
+		}
+	}
+	return result;
+}
+
+/* NOTE(rnp): Incremental: acc += newest - leaving; out = acc / window
+ *            Exponential: acc += (newest - acc) / window; out = acc
+ * either way the cost per frame is a single pass independent of the window size. the
+ * accumulator is kept at full precision so that half precision frames don't drift */
+function void
+do_running_sum_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, u32 program, BeamformerFrame *frame,
+                      BeamformerFrame *aframe, BeamformerSumMode mode, u32 window, Arena arena)
+{
+	BeamformerAverageAccumulator *acc = &cp->average_accumulator;
+
+	GLenum acc_kind = GL_R32F;
+	if (frame->gl_kind == GL_RG32F || frame->gl_kind == GL_RG16F)
+		acc_kind = GL_RG32F;
+
+	if (!beamformer_frame_compatible(&acc->frame, frame->dim, acc_kind)) {
+		alloc_beamform_frame(&ctx->gl, &acc->frame, frame->dim, acc_kind, s8("Average Accumulator"), arena);
+		acc->count = 0;
+	}
+
+	if (acc->mode != mode || acc->window != window) {
+		acc->mode   = mode;
+		acc->window = window;
+		acc->count  = 0;
+	}
+
+	BeamformerFrame *leaving = 0;
+	if (mode == BeamformerSumMode_Incremental && acc->count == window) {
+		/* NOTE(rnp): if the frame leaving the window is no longer cached (it was evicted
+		 * or reused) the sum must be rebuilt from scratch */
+		beamformer_frame_cache_lock(&ctx->frame_cache);
+		leaving = beamformer_average_accumulator_pin(acc, window, frame);
+		beamformer_frame_cache_unlock(&ctx->frame_cache);
+		if (leaving) beamformer_frame_wait(leaving);
+		else         acc->count = 0;
+	}
+
+	if (acc->count == 0) {
+		glClearTexImage(acc->frame.texture, 0, GL_RED, GL_FLOAT, 0);
+		glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+	}
+	acc->count = MIN(acc->count + 1, window);
+
+	/* NOTE(rnp): while the window is filling both modes weight by the current count;
+	 * an image unit with no texture bound reads as zero so nothing leaves the sum */
+	glBindImageTexture(0, aframe->texture,     0, GL_TRUE, 0, GL_WRITE_ONLY, aframe->gl_kind);
+	glBindImageTexture(1, frame->texture,      0, GL_TRUE, 0, GL_READ_ONLY,  frame->gl_kind);
+	glBindImageTexture(2, leaving ? leaving->texture : 0, 0, GL_TRUE, 0, GL_READ_ONLY, frame->gl_kind);
+	glBindImageTexture(3, acc->frame.texture,  0, GL_TRUE, 0, GL_READ_WRITE, acc_kind);
+	glProgramUniform1f(program, SUM_PRESCALE_UNIFORM_LOC, 1.0f / (f32)acc->count);
+	glProgramUniform1i(program, SUM_MODE_UNIFORM_LOC,     (i32)mode);
+
+	glDispatchCompute(ORONE((u32)frame->dim.x / 32u),
+	                  ORONE((u32)frame->dim.y),
+	                  ORONE((u32)frame->dim.z / 32u));
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	if (leaving) beamformer_frame_unpin(&ctx->frame_cache, leaving);
+}
+
 struct compute_cursor {
 	iv3 cursor;
 	uv3 dispatch;
@@ -441,8 +912,10 @@ das_ubo_from_beamformer_parameters(BeamformerDASUBO *du, BeamformerParameters *b
 		du->shader_flags |= BeamformerShaderDASFlags_RxColumns;
 }
 
-function void
-plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb)
+/* NOTE(rnp): returns 0 when the pipeline can't run with this worker configuration; the
+ * plan is left without any stages so uploaded data is released unprocessed */
+function b32
+plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb, u32 worker_count)
 {
 	BeamformerDASUBO *bp = &cp->das_ubo_data;
 
@@ -451,18 +924,27 @@ plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb)
 	b32 decode_first = pb->pipeline.shaders[0] == BeamformerShaderKind_Decode;
 	b32 run_cuda_hilbert = 0;
 	b32 demodulate       = 0;
+	b32 cuda_stage       = 0;
 
 	for (u32 i = 0; i < pb->pipeline.shader_count; i++) {
 		switch (pb->pipeline.shaders[i]) {
-		case BeamformerShaderKind_CudaHilbert:{ run_cuda_hilbert = 1; }break;
-		case BeamformerShaderKind_Demodulate:{  demodulate = 1;       }break;
+		case BeamformerShaderKind_CudaHilbert:{ run_cuda_hilbert = 1; cuda_stage = 1; }break;
+		case BeamformerShaderKind_CudaDecode:{  cuda_stage = 1;                       }break;
+		case BeamformerShaderKind_Demodulate:{  demodulate = 1;                       }break;
 		default:{}break;
 		}
 	}
 
 	if (demodulate) run_cuda_hilbert = 0;
 
-	if (demodulate || run_cuda_hilbert) cp->iq_pipeline = 1;
+	cp->iq_pipeline = demodulate || run_cuda_hilbert;
+
+	/* NOTE(rnp): the requested output kind only selects the precision; whether
+	 * or not the output is complex is determined by the pipeline */
+	b32 half_output = pb->parameters.output_data_kind == BeamformerDataKind_Float16 ||
+	                  pb->parameters.output_data_kind == BeamformerDataKind_Float16Complex;
+	if (cp->iq_pipeline) cp->output_data_kind = half_output ? BeamformerDataKind_Float16Complex : BeamformerDataKind_Float32Complex;
+	else                 cp->output_data_kind = half_output ? BeamformerDataKind_Float16        : BeamformerDataKind_Float32;
 
 	BeamformerDataKind data_kind = pb->pipeline.data_kind;
 	cp->pipeline.shader_count = 0;
@@ -518,10 +1000,6 @@ plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb)
 			commit = 1;
 		}break;
 		case BeamformerShaderKind_DAS:{
-			BeamformerDataKind das_data_kind = BeamformerDataKind_Float32;
-			if (demodulate || run_cuda_hilbert)
-				das_data_kind = BeamformerDataKind_Float32Complex;
-
 			i32 local_flags = 0;
 			if ((bp->shader_flags & BeamformerShaderDASFlags_CoherencyWeighting) == 0)
 				local_flags |= BeamformerShaderDASFlags_Fast;
@@ -530,7 +1008,15 @@ plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb)
 			if (pb->parameters.interpolate)
 				local_flags |= BeamformerShaderDASFlags_Interpolate;
 
-			match = beamformer_shader_das_match(das_data_kind, local_flags);
+			match = beamformer_shader_das_match(cp->output_data_kind, local_flags);
+			commit = 1;
+		}break;
+		case BeamformerShaderKind_MinMax:{
+			match  = beamformer_shader_minmax_match(cp->output_data_kind);
+			commit = 1;
+		}break;
+		case BeamformerShaderKind_Sum:{
+			match  = beamformer_shader_sum_match(cp->output_data_kind);
 			commit = 1;
 		}break;
 		default:{
@@ -548,6 +1034,11 @@ plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb)
 	}
 	cp->pipeline.data_kind = data_kind;
 
+	/* NOTE(rnp): the cuda library keeps one global set of buffers and isn't safe to
+	 * call from more than one GL context */
+	b32 result = !cuda_stage || worker_count == 1;
+	if (!result) cp->pipeline.shader_count = 0;
+
 	u32 das_sample_stride   = 1;
 	u32 das_transmit_stride = bp->sample_count;
 	u32 das_channel_stride  = bp->acquisition_count * bp->sample_count;
@@ -645,36 +1136,46 @@ plan_compute_pipeline(BeamformerComputePlan *cp, BeamformerParameterBlock *pb)
 	flt->input_channel_stride   = bp->sample_count * bp->acquisition_count;
 	flt->input_sample_stride    = 1;
 	flt->input_transmit_stride  = bp->sample_count;
+
+	return result;
 }
 
 function void
-beamformer_commit_parameter_block(BeamformerCtx *ctx, BeamformerComputePlan *cp, u32 block, Arena arena)
+beamformer_commit_parameter_block(BeamformerCtx *ctx, BeamformerComputeWorker *worker,
+                                  BeamformerComputePlan *cp, u32 block, Arena arena)
 {
-	BeamformerParameterBlock *pb = beamformer_parameter_block_lock(&ctx->shared_memory, block, -1);
-	for (u32 region = ctz_u32(pb->dirty_regions);
+	/* NOTE(rnp): the snapshot is taken after the dirty regions so anything published in
+	 * between is either part of it or will be committed again next time */
+	u32 dirty_regions = take_parameter_block_dirty_regions(ctx->shared_memory.region, block);
+	BeamformerParameterBlock *pb = push_struct(&arena, BeamformerParameterBlock);
+	beamformer_parameter_block_snapshot(ctx->shared_memory.region, block, pb);
+
+	for (u32 region = ctz_u32(dirty_regions);
 	     region != 32;
-	     region = ctz_u32(pb->dirty_regions))
+	     region = ctz_u32(dirty_regions))
 	{
-		mark_parameter_block_region_clean(ctx->shared_memory.region, block, region);
+		dirty_regions &= ~(1u << region);
 		switch (region) {
 		case BeamformerParameterBlockRegion_ComputePipeline:
 		case BeamformerParameterBlockRegion_Parameters:
 		{
-			plan_compute_pipeline(cp, pb);
+			if (!plan_compute_pipeline(cp, pb, ctx->compute_context.worker_count)) {
+				os_write_file(ctx->os.error_handle,
+				              s8("pipeline rejected: CUDA stages require --compute-workers 1\n"));
+			}
 
 			/* NOTE(rnp): these are both handled by plan_compute_pipeline() */
 			u32 mask = 1 << BeamformerParameterBlockRegion_ComputePipeline |
 			           1 << BeamformerParameterBlockRegion_Parameters;
-			pb->dirty_regions &= ~mask;
+			dirty_regions &= ~mask;
 
 			#define X(k, t, v) glNamedBufferSubData(cp->ubos[BeamformerComputeUBOKind_##k], \
 			                                        0, sizeof(t), &cp->v ## _ubo_data);
 			BEAMFORMER_COMPUTE_UBO_LIST
 			#undef X
 
-			u32 decoded_data_size = cp->rf_size;
-			if (ctx->compute_context.ping_pong_ssbo_size < decoded_data_size)
-				alloc_shader_storage(ctx, decoded_data_size, arena);
+			if (cp->interstage_buffers[0].size != beamformer_buffer_pool_size_class(cp->rf_size))
+				alloc_shader_storage(ctx, worker, cp, block, arena);
 
 			if (cp->hadamard_order != (i32)cp->das_ubo_data.acquisition_count)
 				update_hadamard_texture(cp, (i32)cp->das_ubo_data.acquisition_count, arena);
@@ -687,10 +1188,10 @@ beamformer_commit_parameter_block(BeamformerCtx *ctx, BeamformerComputePlan *cp,
 			cp->output_points.E[2] = MAX(pb->parameters.output_points[2], 1);
 			cp->average_frames     = pb->parameters.output_points[3];
 
-			GLenum gl_kind = cp->iq_pipeline ? GL_RG32F : GL_R32F;
-			if (cp->average_frames > 1 && !beamformer_frame_compatible(ctx->averaged_frames + 0, cp->output_points, gl_kind)) {
-				alloc_beamform_frame(&ctx->gl, ctx->averaged_frames + 0, cp->output_points, gl_kind, s8("Averaged Frame"), arena);
-				alloc_beamform_frame(&ctx->gl, ctx->averaged_frames + 1, cp->output_points, gl_kind, s8("Averaged Frame"), arena);
+			GLenum gl_kind = gl_kind_from_output_data_kind(cp->output_data_kind);
+			if (cp->average_frames > 1 && !beamformer_frame_compatible(cp->averaged_frames + 0, cp->output_points, gl_kind)) {
+				alloc_beamform_frame(&ctx->gl, cp->averaged_frames + 0, cp->output_points, gl_kind, s8("Averaged Frame"), arena);
+				alloc_beamform_frame(&ctx->gl, cp->averaged_frames + 1, cp->output_points, gl_kind, s8("Averaged Frame"), arena);
 			}
 		}break;
 		case BeamformerParameterBlockRegion_ChannelMapping:
@@ -726,23 +1227,23 @@ beamformer_commit_parameter_block(BeamformerCtx *ctx, BeamformerComputePlan *cp,
 		}break;
 		}
 	}
-	beamformer_parameter_block_unlock(&ctx->shared_memory, block);
 }
 
 function void
-do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame *frame,
-                  BeamformerShaderKind shader, u32 program_index, BeamformerShaderParameters *sp, Arena arena)
+do_compute_shader(BeamformerCtx *ctx, BeamformerComputeWorker *worker, BeamformerComputePlan *cp,
+                  BeamformerFrame *frame, BeamformerShaderKind shader, u32 program_index,
+                  BeamformerShaderParameters *sp, Arena arena)
 {
 	BeamformerComputeContext *cc = &ctx->compute_context;
 
 	i32 *match_vector = beamformer_shader_match_vectors[program_index];
 	BeamformerShaderDescriptor *shader_descriptor = beamformer_shader_descriptors + shader;
 
-	u32 program = cc->programs[program_index];
+	u32 program = worker->programs[program_index];
 	glUseProgram(program);
 
-	u32 output_ssbo_idx = !cc->last_output_ssbo_index;
-	u32 input_ssbo_idx  = cc->last_output_ssbo_index;
+	u32 output_ssbo_idx = !worker->last_output_ssbo_index;
+	u32 input_ssbo_idx  = worker->last_output_ssbo_index;
 
 	switch (shader) {
 	case BeamformerShaderKind_Decode:{
@@ -750,7 +1251,7 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 		glBindImageTexture(0, cp->textures[BeamformerComputeTextureKind_Hadamard], 0, 0, 0, GL_READ_ONLY, GL_R8I);
 
 		if (shader == cp->pipeline.shaders[0]) {
-			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cc->ping_pong_ssbos[input_ssbo_idx]);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cp->interstage_buffers[input_ssbo_idx].buffer);
 			glBindImageTexture(1, cp->textures[BeamformerComputeTextureKind_ChannelMapping], 0, 0, 0, GL_READ_ONLY, GL_R16I);
 			glProgramUniform1ui(program, DECODE_FIRST_PASS_UNIFORM_LOC, 1);
 
@@ -758,23 +1259,25 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 		}
 
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cc->ping_pong_ssbos[input_ssbo_idx]);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, cc->ping_pong_ssbos[output_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cp->interstage_buffers[input_ssbo_idx].buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, cp->interstage_buffers[output_ssbo_idx].buffer);
 
 		glProgramUniform1ui(program, DECODE_FIRST_PASS_UNIFORM_LOC, 0);
 
 		glDispatchCompute(cp->decode_dispatch.x, cp->decode_dispatch.y, cp->decode_dispatch.z);
 		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-		cc->last_output_ssbo_index = !cc->last_output_ssbo_index;
+		worker->last_output_ssbo_index = !worker->last_output_ssbo_index;
 	}break;
 	case BeamformerShaderKind_CudaDecode:{
+		cuda_register_plan_buffers(cc, cp);
 		cuda_decode(0, output_ssbo_idx, 0);
-		cc->last_output_ssbo_index = !cc->last_output_ssbo_index;
+		worker->last_output_ssbo_index = !worker->last_output_ssbo_index;
 	}break;
 	case BeamformerShaderKind_CudaHilbert:{
+		cuda_register_plan_buffers(cc, cp);
 		cuda_hilbert(input_ssbo_idx, output_ssbo_idx);
-		cc->last_output_ssbo_index = !cc->last_output_ssbo_index;
+		worker->last_output_ssbo_index = !worker->last_output_ssbo_index;
 	}break;
 	case BeamformerShaderKind_Filter:
 	case BeamformerShaderKind_Demodulate:
@@ -785,10 +1288,10 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 		u32 index = shader == BeamformerShaderKind_Filter ? BeamformerComputeUBOKind_Filter
 		                                                  : BeamformerComputeUBOKind_Demodulate;
 		glBindBufferBase(GL_UNIFORM_BUFFER,        0, cp->ubos[index]);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cc->ping_pong_ssbos[output_ssbo_idx]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cp->interstage_buffers[output_ssbo_idx].buffer);
 
 		if (!map_channels)
-			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cc->ping_pong_ssbos[input_ssbo_idx]);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cp->interstage_buffers[input_ssbo_idx].buffer);
 
 		GLenum kind = cp->filters[sp->filter_slot].parameters.complex? GL_RG32F : GL_R32F;
 		glBindImageTexture(0, cp->filters[sp->filter_slot].texture, 0, 0, 0, GL_READ_ONLY, kind);
@@ -799,18 +1302,26 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 		glDispatchCompute(cp->demod_dispatch.x, cp->demod_dispatch.y, cp->demod_dispatch.z);
 		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-		cc->last_output_ssbo_index = !cc->last_output_ssbo_index;
+		worker->last_output_ssbo_index = !worker->last_output_ssbo_index;
 	}break;
 	case BeamformerShaderKind_MinMax:{
-		for (i32 i = 1; i < frame->mips; i++) {
-			glBindImageTexture(0, frame->texture, i - 1, GL_TRUE, 0, GL_READ_ONLY,  GL_RG32F);
-			glBindImageTexture(1, frame->texture, i - 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RG32F);
-			glProgramUniform1i(cc->programs[shader], MIN_MAX_MIPS_LEVEL_UNIFORM_LOC, i);
-
-			u32 width  = (u32)frame->dim.x >> i;
-			u32 height = (u32)frame->dim.y >> i;
-			u32 depth  = (u32)frame->dim.z >> i;
-			glDispatchCompute(ORONE(width / 32), ORONE(height), ORONE(depth / 32));
+		for (i32 level = 0; level + 1 < frame->mips; level += MIN_MAX_LEVELS_PER_DISPATCH) {
+			i32 level_count = MIN(MIN_MAX_LEVELS_PER_DISPATCH, frame->mips - 1 - level);
+			glBindImageTexture(0, frame->texture, level, GL_TRUE, 0, GL_READ_ONLY, frame->gl_kind);
+			/* NOTE(rnp): unused outputs are bound to the last level but never written */
+			for (i32 i = 1; i <= MIN_MAX_LEVELS_PER_DISPATCH; i++) {
+				glBindImageTexture((u32)i, frame->texture, level + MIN(i, level_count), GL_TRUE, 0,
+				                   GL_WRITE_ONLY, frame->gl_kind);
+			}
+			glProgramUniform1i(program, MIN_MAX_MIPS_LEVEL_UNIFORM_LOC,  level);
+			glProgramUniform1i(program, MIN_MAX_LEVEL_COUNT_UNIFORM_LOC, level_count);
+
+			u32 width  = (u32)MAX(1, frame->dim.x >> (level + 1));
+			u32 height = (u32)MAX(1, frame->dim.y >> (level + 1));
+			u32 depth  = (u32)MAX(1, frame->dim.z >> (level + 1));
+			glDispatchCompute((u32)ceil_f32((f32)width  / MIN_MAX_LOCAL_SIZE),
+			                  (u32)ceil_f32((f32)height / MIN_MAX_LOCAL_SIZE),
+			                  (u32)ceil_f32((f32)depth  / MIN_MAX_LOCAL_SIZE));
 			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 		}
 	}break;
@@ -824,20 +1335,20 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 		if (fast) {
 			glClearTexImage(frame->texture, 0, GL_RED, GL_FLOAT, 0);
 			glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
-			glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_READ_WRITE, cp->iq_pipeline ? GL_RG32F : GL_R32F);
+			glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_READ_WRITE, frame->gl_kind);
 		} else {
-			glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, cp->iq_pipeline ? GL_RG32F : GL_R32F);
+			glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, frame->gl_kind);
 		}
 
 		u32 sparse_texture = cp->textures[BeamformerComputeTextureKind_SparseElements];
 		if (!sparse) sparse_texture = 0;
 
 		glBindBufferBase(GL_UNIFORM_BUFFER, 0, cp->ubos[BeamformerComputeUBOKind_DAS]);
-		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, cc->ping_pong_ssbos[input_ssbo_idx], 0, cp->rf_size);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, cp->interstage_buffers[input_ssbo_idx].buffer, 0, cp->rf_size);
 		glBindImageTexture(1, sparse_texture, 0, 0, 0, GL_READ_ONLY, GL_R16I);
 		glBindImageTexture(2, cp->textures[BeamformerComputeTextureKind_FocalVectors], 0, 0, 0, GL_READ_ONLY, GL_RG32F);
 
-		glProgramUniform1ui(program, DAS_CYCLE_T_UNIFORM_LOC, cycle_t++);
+		glProgramUniform1ui(program, DAS_CYCLE_T_UNIFORM_LOC, worker->cycle_t++);
 
 		if (fast) {
 			i32 loop_end;
@@ -851,17 +1362,20 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 				loop_end = (i32)ubo->channel_count;
 			}
 			f32 percent_per_step = 1.0f / (f32)loop_end;
-			cc->processing_progress = -percent_per_step;
+			worker->processing_progress = -percent_per_step;
+			cp->das_dispatch_count  = (u32)loop_end;
+			BeamformerDispatchPacer pacer = beamformer_dispatch_pacer_begin(cp->das_dispatch_time_ns);
 			for (i32 index = 0; index < loop_end; index++) {
-				cc->processing_progress += percent_per_step;
-				/* IMPORTANT(rnp): prevents OS from coalescing and killing our shader */
-				glFinish();
+				worker->processing_progress += percent_per_step;
+				beamformer_dispatch_pacer_wait(&pacer);
 				glProgramUniform1i(program, DAS_FAST_CHANNEL_UNIFORM_LOC, index);
 				glDispatchCompute((u32)ceil_f32((f32)frame->dim.x / DAS_LOCAL_SIZE_X),
 				                  (u32)ceil_f32((f32)frame->dim.y / DAS_LOCAL_SIZE_Y),
 				                  (u32)ceil_f32((f32)frame->dim.z / DAS_LOCAL_SIZE_Z));
 				glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+				beamformer_dispatch_pacer_submit(&pacer);
 			}
+			beamformer_dispatch_pacer_end(&pacer);
 		} else {
 			#if 1
 			/* TODO(rnp): compute max_points_per_dispatch based on something like a
@@ -869,17 +1383,20 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 			u32 max_points_per_dispatch = KB(64);
 			struct compute_cursor cursor = start_compute_cursor(frame->dim, max_points_per_dispatch);
 			f32 percent_per_step = (f32)cursor.points_per_dispatch / (f32)cursor.total_points;
-			cc->processing_progress = -percent_per_step;
+			worker->processing_progress = -percent_per_step;
+			cp->das_dispatch_count  = (u32)ceil_f32((f32)cursor.total_points / (f32)cursor.points_per_dispatch);
+			BeamformerDispatchPacer pacer = beamformer_dispatch_pacer_begin(cp->das_dispatch_time_ns);
 			for (iv3 offset = {0};
 			     !compute_cursor_finished(&cursor);
 			     offset = step_compute_cursor(&cursor))
 			{
-				cc->processing_progress += percent_per_step;
-				/* IMPORTANT(rnp): prevents OS from coalescing and killing our shader */
-				glFinish();
+				worker->processing_progress += percent_per_step;
+				beamformer_dispatch_pacer_wait(&pacer);
 				glProgramUniform3iv(program, DAS_VOXEL_OFFSET_UNIFORM_LOC, 1, offset.E);
 				glDispatchCompute(cursor.dispatch.x, cursor.dispatch.y, cursor.dispatch.z);
+				beamformer_dispatch_pacer_submit(&pacer);
 			}
+			beamformer_dispatch_pacer_end(&pacer);
 			#else
 			/* NOTE(rnp): use this for testing tiling code. The performance of the above path
 			 * should be the same as this path if everything is working correctly */
@@ -893,25 +1410,53 @@ do_compute_shader(BeamformerCtx *ctx, BeamformerComputePlan *cp, BeamformerFrame
 		glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT|GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 	}break;
 	case BeamformerShaderKind_Sum:{
-		u32 aframe_index = ctx->averaged_frame_index % ARRAY_COUNT(ctx->averaged_frames);
-		BeamformerFrame *aframe = ctx->averaged_frames + aframe_index;
-		aframe->id              = ctx->averaged_frame_index;
+		u32 aframe_index = cp->averaged_frame_index % countof(cp->averaged_frames);
+		BeamformerFrame *aframe = cp->averaged_frames + aframe_index;
+		aframe->id              = cp->averaged_frame_index;
 		atomic_store_u32(&aframe->ready_to_present, 0);
 		/* TODO(rnp): hack we need a better way of specifying which frames to sum;
 		 * this is fine for rolling averaging but what if we want to do something else */
-		assert(frame >= ctx->beamform_frames);
-		assert(frame < ctx->beamform_frames + countof(ctx->beamform_frames));
-		u32 base_index   = (u32)(frame - ctx->beamform_frames);
-		u32 to_average   = (u32)cp->average_frames;
-		u32 frame_count  = 0;
-		u32 *in_textures = push_array(&arena, u32, BeamformerMaxSavedFrames);
-		ComputeFrameIterator cfi = compute_frame_iterator(ctx, 1 + base_index - to_average, to_average);
-		for (BeamformerFrame *it = frame_next(&cfi); it; it = frame_next(&cfi))
-			in_textures[frame_count++] = it->texture;
-
-		assert(to_average == frame_count);
-
-		do_sum_shader(cc, in_textures, frame_count, 1 / (f32)frame_count, aframe->texture, aframe->dim);
+		BeamformerFrameCache         *fc  = &ctx->frame_cache;
+		BeamformerAverageAccumulator *acc = &cp->average_accumulator;
+		u32 to_average = MAX(1, (u32)cp->average_frames);
+
+		beamformer_average_accumulator_push(acc, frame);
+
+		BeamformerSumMode mode = sp->sum_mode;
+		/* NOTE(rnp): the frame leaving the window must still be resident */
+		if (mode == BeamformerSumMode_Incremental && to_average >= countof(fc->frames))
+			mode = BeamformerSumMode_Full;
+
+		if (mode == BeamformerSumMode_Incremental || mode == BeamformerSumMode_Exponential) {
+			do_running_sum_shader(ctx, cp, program, frame, aframe, mode, to_average, arena);
+		} else {
+			/* NOTE(rnp): average whichever frames summed in the window are still cached */
+			u32 frame_count  = 0;
+			u32 window       = MIN(to_average, countof(acc->summed_frames));
+			u32 *in_textures = push_array(&arena, u32, window);
+			BeamformerFrame **in_frames = push_array(&arena, BeamformerFrame *, window);
+			beamformer_frame_cache_lock(fc);
+			for (u32 back = 0; back < window; back++) {
+				BeamformerFrame *f = beamformer_average_accumulator_pin(acc, back, frame);
+				if (f) in_frames[frame_count++] = f;
+			}
+			beamformer_frame_cache_unlock(fc);
+
+			assert(frame_count > 0 && frame_count <= to_average);
+
+			for (u32 i = 0; i < frame_count; i++) {
+				if (in_frames[i] != frame) beamformer_frame_wait(in_frames[i]);
+				in_textures[i] = in_frames[i]->texture;
+			}
+
+			do_sum_shader(program, in_textures, frame_count, 1 / (f32)frame_count, aframe->texture,
+			              aframe->dim, aframe->gl_kind);
+
+			beamformer_frame_cache_lock(fc);
+			for (u32 i = 0; i < frame_count; i++)
+				in_frames[i]->pins--;
+			beamformer_frame_cache_unlock(fc);
+		}
 		aframe->min_coordinate  = frame->min_coordinate;
 		aframe->max_coordinate  = frame->max_coordinate;
 		aframe->compound_count  = frame->compound_count;
@@ -959,12 +1504,40 @@ stream_push_shader_header(Stream *s, ShaderReloadContext *ctx)
 		));
 	}break;
 	case BeamformerShaderKind_MinMax:{
-		stream_append_s8(s, s8("layout(location = " str(MIN_MAX_MIPS_LEVEL_UNIFORM_LOC)
-		                       ") uniform int u_mip_map;\n\n"));
+		stream_append_s8(s, s8(""
+		"#define MIN_MAX_LOCAL_SIZE " str(MIN_MAX_LOCAL_SIZE) "\n\n"
+		"layout(local_size_x = " str(MIN_MAX_LOCAL_SIZE) ", "
+		       "local_size_y = " str(MIN_MAX_LOCAL_SIZE) ", "
+		       "local_size_z = " str(MIN_MAX_LOCAL_SIZE) ") in;\n\n"
+		"layout(location = " str(MIN_MAX_MIPS_LEVEL_UNIFORM_LOC)  ") uniform int u_mip_map;\n"
+		"layout(location = " str(MIN_MAX_LEVEL_COUNT_UNIFORM_LOC) ") uniform int u_level_count;\n\n"
+		));
+	}break;
+	case BeamformerShaderKind_Export:{
+		stream_append_s8(s, s8(""
+		"layout(local_size_x = " str(EXPORT_LOCAL_SIZE) ", local_size_y = 1, local_size_z = 1) in;\n\n"
+		"layout(location = " str(EXPORT_PROCESSING_UNIFORM_LOC)    ") uniform int   u_processing;\n"
+		"layout(location = " str(EXPORT_DYNAMIC_RANGE_UNIFORM_LOC) ") uniform float u_dynamic_range;\n"
+		"layout(location = " str(EXPORT_REFERENCE_UNIFORM_LOC)     ") uniform float u_reference;\n"
+		"layout(location = " str(EXPORT_ROI_OFFSET_UNIFORM_LOC)    ") uniform ivec3 u_roi_offset;\n"
+		"layout(location = " str(EXPORT_DECIMATION_UNIFORM_LOC)    ") uniform ivec3 u_decimation;\n"
+		"layout(location = " str(EXPORT_OUTPUT_POINTS_UNIFORM_LOC) ") uniform ivec3 u_output_points;\n"
+		"layout(location = " str(EXPORT_WORD_COUNT_UNIFORM_LOC)    ") uniform uint  u_word_count;\n\n"
+		));
+
+		#define X(k, id, ...) "#define ExportProcessing_" #k " " #id "\n"
+		stream_append_s8s(s, s8(BEAMFORMER_EXPORT_PROCESSING_LIST), s8("\n"));
+		#undef X
 	}break;
 	case BeamformerShaderKind_Sum:{
-		stream_append_s8(s, s8("layout(location = " str(SUM_PRESCALE_UNIFORM_LOC)
-		                       ") uniform float u_sum_prescale = 1.0;\n\n"));
+		stream_append_s8(s, s8(""
+		"layout(location = " str(SUM_PRESCALE_UNIFORM_LOC) ") uniform float u_sum_prescale = 1.0;\n"
+		"layout(location = " str(SUM_MODE_UNIFORM_LOC)     ") uniform int   u_sum_mode;\n\n"
+		));
+
+		#define X(k, id, ...) "#define SumMode_" #k " " #id "\n"
+		stream_append_s8s(s, s8(BEAMFORMER_SUM_MODE_LIST), s8("\n"));
+		#undef X
 	}break;
 	default:{}break;
 	}
@@ -1087,8 +1660,11 @@ reload_compute_shader(BeamformerCtx *ctx, ShaderReloadContext *src, Arena arena)
 			s8 shader_text = stream_to_s8(&shader);
 			/* TODO(rnp): instance name */
 			s8 shader_name = beamformer_shader_names[rsi->kind];
-			glDeleteProgram(cc->programs[instance]);
-			cc->programs[instance] = load_shader(&ctx->os, arena, &shader_text, &src->gl_type, 1, shader_name);
+			for (u32 worker = 0; worker < cc->worker_count; worker++) {
+				u32 *program = cc->workers[worker].programs + instance;
+				glDeleteProgram(*program);
+				*program = load_shader(&ctx->os, arena, &shader_text, &src->gl_type, 1, shader_name);
+			}
 
 			status.widx = 0;
 			stream_append_s8s(&status, s8("\r\x1b[2Kloaded shader "), shader_name, s8(": ["));
@@ -1102,129 +1678,345 @@ reload_compute_shader(BeamformerCtx *ctx, ShaderReloadContext *src, Arena arena)
 	os_write_file(ctx->os.error_handle, s8("\n"));
 }
 
+/* NOTE(rnp): compute indirect is submitted alongside its upload so the upload may not have
+ * landed yet. the slot may also still hold an older upload which another worker hasn't
+ * consumed; wait until it holds the one assigned to this work */
 function void
-complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena *arena, iptr gl_context)
+beamformer_rf_wait_for_upload(BeamformerRFBuffer *rf, BeamformerComputeWorkContext *cwc)
+{
+	spin_wait(!atomic_load_u64(rf->upload_syncs + cwc->rf_slot) ||
+	          atomic_load_u32(rf->upload_sequence + cwc->rf_slot) != cwc->rf_sequence);
+}
+
+function void
+beamformer_signal_frames_completed(BeamformerSharedMemory *sm, u32 block, u32 count)
+{
+	atomic_add_u32(sm->completed_frames + block, count);
+	os_wake_all_waiters(sm->completed_frames + block);
+}
+
+function void
+beamformer_readback_complete(BeamformerCtx *ctx, BeamformerReadback *rb)
+{
+	BeamformerSharedMemory *sm = ctx->shared_memory.region;
+	switch (rb->kind) {
+	case BeamformerReadbackKind_ExportBuffer:{
+		mem_copy(beamformer_shared_memory_scratch_arena(sm).beg, rb->mapped, rb->size);
+		os_shared_memory_region_unlock(&ctx->shared_memory, sm->locks, (i32)rb->target);
+		post_sync_barrier(&ctx->shared_memory, BeamformerSharedMemoryLockKind_ExportSync, sm->locks);
+	}break;
+	case BeamformerReadbackKind_ExportStream:{
+		BeamformerExportSlot *slot = sm->export_slots + rb->target;
+		mem_copy(beamformer_export_slot_data(sm, rb->target), rb->mapped, rb->size);
+		memory_write_barrier();
+		atomic_add_u32(&slot->sequence, 1);
+		os_wake_all_waiters(&slot->sequence);
+	}break;
+	InvalidDefaultCase;
+	}
+}
+
+/* NOTE(rnp): completes every readback whose fence has signalled. readbacks finish in the
+ * order they were started. if wait is set this blocks until all of them have finished */
+function void
+beamformer_collect_readbacks(BeamformerCtx *ctx, BeamformerComputeWorker *worker, b32 wait)
+{
+	while (worker->readback_read_index != worker->readback_write_index) {
+		BeamformerReadback *rb = worker->readbacks + worker->readback_read_index % countof(worker->readbacks);
+		GLenum status = glClientWaitSync(rb->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+		if (status == GL_TIMEOUT_EXPIRED)
+			break;
+		glDeleteSync(rb->fence);
+		rb->fence = 0;
+		beamformer_readback_complete(ctx, rb);
+		worker->readback_read_index++;
+	}
+}
+
+/* NOTE(rnp): starts an asynchronous read of region (computed from options) of frame into the
+ * next readback buffer. unless the whole frame is wanted as is, the export shader first reduces
+ * it directly into the buffer. the caller fills in kind and target; the copy to its destination happens in
+ * beamformer_collect_readbacks */
+function BeamformerReadback *
+beamformer_readback_begin(BeamformerCtx *ctx, BeamformerComputeWorker *worker, BeamformerFrame *frame,
+                          BeamformerExportOptions *options, BeamformerExportRegion *region)
+{
+	u32 size       = (u32)region->size;
+	u32 word_count = (size + 3) / 4;
+
+	/* NOTE(rnp): only stall on old readbacks if the ring is full */
+	if (worker->readback_write_index - worker->readback_read_index == countof(worker->readbacks))
+		beamformer_collect_readbacks(ctx, worker, 1);
+
+	BeamformerReadback *result = worker->readbacks + worker->readback_write_index % countof(worker->readbacks);
+	if (result->capacity < 4 * word_count) {
+		if (result->pbo) {
+			glUnmapNamedBuffer(result->pbo);
+			glDeleteBuffers(1, &result->pbo);
+		}
+		result->capacity = (u32)round_up_to(4 * word_count, MB(1));
+		glCreateBuffers(1, &result->pbo);
+		u32 flags = GL_MAP_READ_BIT|GL_MAP_PERSISTENT_BIT|GL_MAP_COHERENT_BIT;
+		glNamedBufferStorage(result->pbo, result->capacity, 0, flags|GL_CLIENT_STORAGE_BIT);
+		result->mapped = glMapNamedBufferRange(result->pbo, 0, (i32)result->capacity, flags);
+		LABEL_GL_OBJECT(GL_BUFFER, result->pbo, s8("Readback_PBO"));
+	}
+
+	if (region->full_frame && region->processing == BeamformerExportProcessing_None) {
+		GLenum format, type;
+		gl_kind_pixel_format(frame->gl_kind, &format, &type);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, result->pbo);
+		glGetTextureImage(frame->texture, 0, format, type, (i32)size, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	} else {
+		iz  match   = beamformer_shader_export_match(output_data_kind_from_gl_kind(frame->gl_kind));
+		u32 program = worker->programs[match];
+		glUseProgram(program);
+		glProgramUniform1i(program,  EXPORT_PROCESSING_UNIFORM_LOC,    (i32)region->processing);
+		glProgramUniform1f(program,  EXPORT_DYNAMIC_RANGE_UNIFORM_LOC, MAX(options->dynamic_range, 1e-3f));
+		glProgramUniform1f(program,  EXPORT_REFERENCE_UNIFORM_LOC,     options->reference > 0 ? options->reference : 1.0f);
+		glProgramUniform3iv(program, EXPORT_ROI_OFFSET_UNIFORM_LOC,    1, region->offset);
+		glProgramUniform3iv(program, EXPORT_DECIMATION_UNIFORM_LOC,    1, region->decimation);
+		glProgramUniform3iv(program, EXPORT_OUTPUT_POINTS_UNIFORM_LOC, 1, region->points);
+		glProgramUniform1ui(program, EXPORT_WORD_COUNT_UNIFORM_LOC,    word_count);
+
+		glBindImageTexture(0, frame->texture, 0, GL_TRUE, 0, GL_READ_ONLY, frame->gl_kind);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, result->pbo, 0, 4 * word_count);
+		/* NOTE(rnp): invocations loop over any words past the capped dispatch */
+		u32 groups = (word_count + EXPORT_LOCAL_SIZE - 1) / EXPORT_LOCAL_SIZE;
+		glDispatchCompute(MIN(groups, EXPORT_MAX_WORKGROUPS), 1, 1);
+		glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+	}
+	result->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	result->size  = size;
+	glFlush();
+
+	worker->readback_write_index++;
+	return result;
+}
+
+/* NOTE(rnp): frame numbers are claimed in order so concurrent workers write different slots.
+ * a slot is only overwritten once the ring has wrapped; readers detect that with the slot's
+ * sequence and frame_number. the slot stays odd until its readback lands */
+function void
+beamformer_export_stream_push(BeamformerCtx *ctx, BeamformerComputeWorker *worker,
+                              BeamformerFrame *frame, u32 parameter_block)
+{
+	BeamformerSharedMemory *sm = ctx->shared_memory.region;
+	BeamformerExportOptions options = sm->export_options;
+
+	GLenum format, type;
+	u32 voxel_size = gl_kind_pixel_format(frame->gl_kind, &format, &type);
+	BeamformerExportRegion region = beamformer_export_region(&options, frame->dim.E, voxel_size);
+	if (region.size <= BEAMFORMER_EXPORT_SLOT_SIZE) {
+		u32 frame_number = atomic_add_u32(&sm->export_stream_write_index, 1);
+		u32 index        = frame_number % BEAMFORMER_EXPORT_SLOT_COUNT;
+		BeamformerExportSlot *slot = sm->export_slots + index;
+
+		/* NOTE(rnp): another worker may still have a readback in flight for this slot */
+		for (;;) {
+			i32 sequence = atomic_load_u32(&slot->sequence) & ~1;
+			if (atomic_cas_u32(&slot->sequence, &sequence, sequence + 1))
+				break;
+			if (worker->readback_read_index != worker->readback_write_index)
+				beamformer_collect_readbacks(ctx, worker, 0);
+		}
+
+		/* NOTE(rnp): a block's frames complete in order on its worker and its count is only
+		 * incremented after this push so it identifies the frame within the block */
+		slot->info = (BeamformerExportFrameInfo){
+			.frame_number          = frame_number,
+			.frame_id              = frame->id,
+			.parameter_block       = parameter_block,
+			.parameter_block_frame = (u32)atomic_load_u32(sm->completed_frames + parameter_block),
+			.view_plane            = frame->view_plane_tag,
+			.data_kind             = output_data_kind_from_gl_kind(frame->gl_kind),
+			.processing            = region.processing,
+			.size                  = (u32)region.size,
+			.points                = {region.points[0], region.points[1], region.points[2]},
+		};
+		for (u32 i = 0; i < 3; i++) {
+			f32 step = (frame->max_coordinate.E[i] - frame->min_coordinate.E[i]) / (f32)MAX(1, frame->dim.E[i] - 1);
+			i32 last = region.offset[i] + (region.points[i] - 1) * region.decimation[i];
+			slot->info.min_coordinate[i] = frame->min_coordinate.E[i] + step * (f32)region.offset[i];
+			slot->info.max_coordinate[i] = frame->min_coordinate.E[i] + step * (f32)last;
+		}
+
+		BeamformerReadback *rb = beamformer_readback_begin(ctx, worker, frame, &options, &region);
+		rb->kind   = BeamformerReadbackKind_ExportStream;
+		rb->target = index;
+	}
+}
+
+function b32
+complete_work(BeamformerCtx *ctx, BeamformerComputeWorker *worker, BeamformWorkQueue *q, BeamformWork *work,
+              Arena *arena, iptr gl_context)
 {
 	BeamformerComputeContext *cs = &ctx->compute_context;
 	BeamformerSharedMemory   *sm = ctx->shared_memory.region;
 
-	BeamformWork *work = beamform_work_queue_pop(q);
-	while (work) {
-		b32 can_commit = 1;
-		switch (work->kind) {
-		case BeamformerWorkKind_ReloadShader:{
-			reload_compute_shader(ctx, work->shader_reload_context, *arena);
-			if (ctx->latest_frame && !sm->live_imaging_parameters.active) {
-				fill_frame_compute_work(ctx, work, ctx->latest_frame->view_plane_tag, 0, 0);
-				can_commit = 0;
-			}
-		}break;
-		case BeamformerWorkKind_ExportBuffer:{
-			/* TODO(rnp): better way of handling DispatchCompute barrier */
-			post_sync_barrier(&ctx->shared_memory, BeamformerSharedMemoryLockKind_DispatchCompute, sm->locks);
-			os_shared_memory_region_lock(&ctx->shared_memory, sm->locks, (i32)work->lock, (u32)-1);
-			BeamformerExportContext *ec = &work->export_context;
-			switch (ec->kind) {
-			case BeamformerExportKind_BeamformedData:{
-				BeamformerFrame *frame = ctx->latest_frame;
-				if (frame) {
-					assert(frame->ready_to_present);
-					u32 texture  = frame->texture;
-					iv3 dim      = frame->dim;
-					u32 out_size = (u32)dim.x * (u32)dim.y * (u32)dim.z * 2 * sizeof(f32);
-					if (out_size <= ec->size) {
-						glGetTextureImage(texture, 0, GL_RG, GL_FLOAT, (i32)out_size,
-						                  beamformer_shared_memory_scratch_arena(sm).beg);
-					}
+	b32 can_commit = 1;
+	switch (work->kind) {
+	case BeamformerWorkKind_ReloadShader:{
+		reload_compute_shader(ctx, beamform_work_queue_payload(q, work)->shader_reload_context, *arena);
+		if (ctx->latest_frame && !sm->live_imaging_parameters.active) {
+			fill_frame_compute_work(ctx, work, ctx->latest_frame->view_plane_tag, 0, 0);
+			can_commit = 0;
+		}
+	}break;
+	case BeamformerWorkKind_ExportBuffer:{
+		/* TODO(rnp): better way of handling DispatchCompute barrier */
+		post_sync_barrier(&ctx->shared_memory, BeamformerSharedMemoryLockKind_DispatchCompute, sm->locks);
+		os_shared_memory_region_lock(&ctx->shared_memory, sm->locks, (i32)work->lock, (u32)-1);
+		BeamformerExportContext *ec = &work->export_context;
+		b32 export_pending = 0;
+		switch (ec->kind) {
+		case BeamformerExportKind_BeamformedData:{
+			BeamformerFrame *frame = ctx->latest_frame;
+			if (frame) {
+				assert(frame->ready_to_present);
+				beamformer_frame_wait(frame);
+				GLenum format, type;
+				u32 voxel_size = gl_kind_pixel_format(frame->gl_kind, &format, &type);
+				/* NOTE(rnp): the options the size was promised with, not the current ones */
+				BeamformerExportOptions options = sm->export_buffer_options;
+				BeamformerExportRegion  region  = beamformer_export_region(&options, frame->dim.E, voxel_size);
+				if (region.size <= ec->size) {
+					/* NOTE(rnp): the lock and the ExportSync barrier are released once
+					 * the data has been copied into scratch */
+					BeamformerReadback *rb = beamformer_readback_begin(ctx, worker, frame, &options, &region);
+					rb->kind       = BeamformerReadbackKind_ExportBuffer;
+					rb->target     = work->lock;
+					export_pending = 1;
 				}
-			}break;
-			case BeamformerExportKind_Stats:{
-				ComputeTimingTable *table = ctx->compute_timing_table;
-				/* NOTE(rnp): do a little spin to let this finish updating */
-				while (table->write_index != atomic_load_u32(&table->read_index));
-				ComputeShaderStats *stats = ctx->compute_shader_stats;
-				if (sizeof(stats->table) <= ec->size)
-					mem_copy(beamformer_shared_memory_scratch_arena(sm).beg, &stats->table, sizeof(stats->table));
-			}break;
-			InvalidDefaultCase;
 			}
-			os_shared_memory_region_unlock(&ctx->shared_memory, sm->locks, (i32)work->lock);
-			post_sync_barrier(&ctx->shared_memory, BeamformerSharedMemoryLockKind_ExportSync, sm->locks);
 		}break;
-		case BeamformerWorkKind_CreateFilter:{
-			/* TODO(rnp): this should probably get deleted and moved to lazy loading */
-			BeamformerCreateFilterContext *fctx = &work->create_filter_context;
-			u32 block = fctx->parameter_block;
-			u32 slot  = fctx->filter_slot;
-			BeamformerComputePlan *cp = beamformer_compute_plan_for_block(cs, block, arena);
-			beamformer_filter_update(cp->filters + slot, fctx->kind, fctx->parameters, block, slot, *arena);
+		case BeamformerExportKind_Stats:{
+			ComputeTimingTable *table = ctx->compute_timing_table;
+			/* NOTE(rnp): do a little spin to let this finish updating */
+			while (table->write_index != atomic_load_u32(&table->read_index));
+			ComputeShaderStats *stats = ctx->compute_shader_stats;
+			if (sizeof(stats->table) <= ec->size)
+				mem_copy(beamformer_shared_memory_scratch_arena(sm).beg, &stats->table, sizeof(stats->table));
 		}break;
-		case BeamformerWorkKind_ComputeIndirect:{
-			fill_frame_compute_work(ctx, work, work->compute_indirect_context.view_plane,
-			                        work->compute_indirect_context.parameter_block, 1);
-		} /* FALLTHROUGH */
-		case BeamformerWorkKind_Compute:{
-			DEBUG_DECL(glClearNamedBufferData(cs->ping_pong_ssbos[0], GL_RG32F, GL_RG, GL_FLOAT, 0);)
-			DEBUG_DECL(glClearNamedBufferData(cs->ping_pong_ssbos[1], GL_RG32F, GL_RG, GL_FLOAT, 0);)
-			DEBUG_DECL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);)
-
-			push_compute_timing_info(ctx->compute_timing_table,
-			                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_ComputeFrameBegin});
-
-			BeamformerComputePlan *cp = beamformer_compute_plan_for_block(cs, work->compute_context.parameter_block, arena);
-			if (beamformer_parameter_block_dirty(sm, work->compute_context.parameter_block)) {
-				u32 block = work->compute_context.parameter_block;
-				beamformer_commit_parameter_block(ctx, cp, block, *arena);
-				atomic_store_u32(&ctx->ui_dirty_parameter_blocks, (u32)(ctx->beamform_work_queue != q) << block);
-			}
-
+		InvalidDefaultCase;
+		}
+		if (!export_pending) {
+			os_shared_memory_region_unlock(&ctx->shared_memory, sm->locks, (i32)work->lock);
+			post_sync_barrier(&ctx->shared_memory, BeamformerSharedMemoryLockKind_ExportSync, sm->locks);
+		}
+	}break;
+	case BeamformerWorkKind_CreateFilter:{
+		/* TODO(rnp): this should probably get deleted and moved to lazy loading */
+		BeamformerCreateFilterContext *fctx = &work->create_filter_context;
+		u32 block = fctx->parameter_block;
+		u32 slot  = fctx->filter_slot;
+		BeamformerComputePlan *cp = beamformer_compute_plan_for_block(cs, block, arena);
+		BeamformerFilterParameters parameters = beamform_work_queue_payload(q, work)->filter_parameters;
+		beamformer_filter_update(cp->filters + slot, fctx->kind, parameters, block, slot, *arena);
+	}break;
+	/* NOTE(rnp): compute indirect has already been filled in by dispatch_queue() */
+	case BeamformerWorkKind_ComputeIndirect:
+	case BeamformerWorkKind_Compute:
+	{
+		BeamformerComputeWorkContext *cwc = &work->compute_context;
+		if (cwc->flags & BeamformerComputeWorkFlags_Dropped) {
+			/* NOTE(rnp): a newer frame for this block is already queued; only the RF slot
+			 * needs to be handed back to the upload thread */
 			post_sync_barrier(&ctx->shared_memory, work->lock, sm->locks);
+			BeamformerRFBuffer *rf = &cs->rf_buffer;
+			beamformer_rf_wait_for_upload(rf, cwc);
+			u32 dropped_frames = MAX(1, rf->frame_counts[cwc->rf_slot]);
+			glDeleteSync(rf->upload_syncs[cwc->rf_slot]);
+			rf->upload_syncs[cwc->rf_slot] = 0;
+			memory_write_barrier();
+			push_compute_timing_info(ctx->compute_timing_table,
+			                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_DroppedFrame});
+			beamformer_signal_frames_completed(sm, cwc->parameter_block, dropped_frames);
+			break;
+		}
 
-			atomic_store_u32(&cs->processing_compute, 1);
-			start_renderdoc_capture(gl_context);
-
-			BeamformerFrame *frame = work->compute_context.frame;
+		BeamformerComputePlan *cp = beamformer_compute_plan_for_block(cs, cwc->parameter_block, arena);
+		if (beamformer_parameter_block_dirty(sm, cwc->parameter_block)) {
+			u32 block = cwc->parameter_block;
+			beamformer_commit_parameter_block(ctx, worker, cp, block, *arena);
+			if (cwc->flags & BeamformerComputeWorkFlags_External) atomic_or_u32(&ctx->ui_dirty_parameter_blocks, 1u << block);
+		}
 
-			GLenum gl_kind = cp->iq_pipeline ? GL_RG32F : GL_R32F;
-			if (!beamformer_frame_compatible(frame, cp->output_points, gl_kind))
-				alloc_beamform_frame(&ctx->gl, frame, cp->output_points, gl_kind, s8("Beamformed_Data"), *arena);
+		post_sync_barrier(&ctx->shared_memory, work->lock, sm->locks);
+
+		DEBUG_DECL(glClearNamedBufferData(cp->interstage_buffers[0].buffer, GL_RG32F, GL_RG, GL_FLOAT, 0);)
+		DEBUG_DECL(glClearNamedBufferData(cp->interstage_buffers[1].buffer, GL_RG32F, GL_RG, GL_FLOAT, 0);)
+		DEBUG_DECL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);)
+
+		atomic_store_u32(&worker->processing_compute, 1);
+		start_renderdoc_capture(gl_context);
+
+		BeamformerComputeContext  *cc       = &ctx->compute_context;
+		BeamformerComputePipeline *pipeline = &cp->pipeline;
+		BeamformerRFBuffer        *rf       = &cs->rf_buffer;
+
+		/* NOTE(rnp): a multi frame upload places several frames in a single RF slot.
+		 * each of them is beamformed into its own output frame */
+		u32 rf_slot = cwc->rf_slot, rf_first_frame = 0, rf_frame_count = 1;
+		if (cwc->flags & BeamformerComputeWorkFlags_RFUpload) {
+			beamformer_rf_wait_for_upload(rf, cwc);
+			glWaitSync(rf->upload_syncs[rf_slot], 0, GL_TIMEOUT_IGNORED);
+			glDeleteSync(rf->upload_syncs[rf_slot]);
+			/* NOTE(rnp): a rejected upload has a frame count of 0 and holds nothing to beamform */
+			if (pipeline->shader_count > 0 && rf->frame_counts[rf_slot] > 0) {
+				rf_frame_count = rf->frame_counts[rf_slot];
+			} else {
+				/* NOTE(rnp): nothing will read the data; release the slot immediately */
+				rf->upload_syncs[rf_slot] = 0;
+				memory_write_barrier();
+				if (rf->frame_counts[rf_slot] == 0) rf_frame_count = 0;
+			}
+		} else if (pipeline->shader_count > 0) {
+			/* NOTE(rnp): recomputing old data; only redo the newest frame in the slot */
+			rf_first_frame = MAX(1, rf->frame_counts[rf_slot]) - 1;
+			rf_frame_count = rf->frame_counts[rf_slot] > 0 ? rf_first_frame + 1 : 0;
+		}
 
+		for (u32 rf_frame = rf_first_frame; rf_frame < rf_frame_count; rf_frame++) {
+			/* NOTE(rnp): only stall on old queries if the GPU is far behind */
+			if (worker->timer_query_write_index - worker->timer_query_read_index == countof(worker->timer_query_sets))
+				beamformer_collect_timer_queries(cc, worker, ctx->compute_timing_table, 1);
+			u32 query_set_index = worker->timer_query_write_index % countof(worker->timer_query_sets);
+			BeamformerTimerQuerySet *qs = worker->timer_query_sets + query_set_index;
+			qs->shader_count    = pipeline->shader_count;
+			qs->parameter_block = cwc->parameter_block;
+
+			u32 frame_id = cwc->frame_id;
+			if (rf_frame != rf_first_frame)
+				frame_id = atomic_add_u32(&ctx->next_render_frame_index, 1);
+
+			GLenum gl_kind = gl_kind_from_output_data_kind(cp->output_data_kind);
+			BeamformerFrame *frame = beamformer_frame_cache_acquire(&ctx->frame_cache, worker, &ctx->gl,
+			                                                        cp->output_points, gl_kind,
+			                                                        frame_id, *arena);
+			frame->view_plane_tag  = cwc->view_plane;
 			frame->min_coordinate  = cp->min_coordinate;
 			frame->max_coordinate  = cp->max_coordinate;
 			frame->das_kind        = cp->das_ubo_data.shader_kind;
 			frame->compound_count  = cp->das_ubo_data.acquisition_count;
 
-			BeamformerComputeContext  *cc       = &ctx->compute_context;
-			BeamformerComputePipeline *pipeline = &cp->pipeline;
 			/* NOTE(rnp): first stage requires access to raw data buffer directly so we break
 			 * it out into a separate step. This way data can get released as soon as possible */
 			if (pipeline->shader_count > 0) {
-				BeamformerRFBuffer *rf = &cs->rf_buffer;
-				u32 slot = rf->compute_index % countof(rf->compute_syncs);
-
-				/* NOTE(rnp): compute indirect is used when uploading data. in this case the thread
-				 * must wait on an upload fence. if the fence doesn't yet exist the thread must wait */
-				if (work->kind == BeamformerWorkKind_ComputeIndirect)
-					spin_wait(!atomic_load_u64(rf->upload_syncs + slot));
-
-				if (rf->upload_syncs[slot]) {
-					rf->compute_index++;
-					glWaitSync(rf->upload_syncs[slot], 0, GL_TIMEOUT_IGNORED);
-					glDeleteSync(rf->upload_syncs[slot]);
-				} else {
-					slot = (rf->compute_index - 1) % countof(rf->compute_syncs);
-				}
+				glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, rf->ssbo,
+				                  (iz)rf_slot * rf->size + (iz)rf_frame * rf->frame_strides[rf_slot],
+				                  rf->frame_sizes[rf_slot]);
 
-				glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, rf->ssbo, slot * rf->active_rf_size, rf->active_rf_size);
-
-				glBeginQuery(GL_TIME_ELAPSED, cc->shader_timer_ids[0]);
-				do_compute_shader(ctx, cp, frame, pipeline->shaders[0], pipeline->program_indices[0],
+				qs->shaders[0] = pipeline->shaders[0];
+				glBeginQuery(GL_TIME_ELAPSED, qs->queries[0]);
+				do_compute_shader(ctx, worker, cp, frame, pipeline->shaders[0], pipeline->program_indices[0],
 				                  pipeline->parameters + 0, *arena);
 				glEndQuery(GL_TIME_ELAPSED);
 
-				if (work->kind == BeamformerWorkKind_ComputeIndirect) {
-					rf->compute_syncs[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-					rf->upload_syncs[slot]  = 0;
+				if ((cwc->flags & BeamformerComputeWorkFlags_RFUpload) && rf_frame + 1 == rf_frame_count) {
+					rf->compute_syncs[rf_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+					rf->upload_syncs[rf_slot]  = 0;
 					memory_write_barrier();
 				}
 			}
@@ -1232,42 +2024,179 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena *arena, iptr gl_c
 			b32 did_sum_shader = 0;
 			for (u32 i = 1; i < pipeline->shader_count; i++) {
 				did_sum_shader |= pipeline->shaders[i] == BeamformerShaderKind_Sum;
-				glBeginQuery(GL_TIME_ELAPSED, cc->shader_timer_ids[i]);
-				do_compute_shader(ctx, cp, frame, pipeline->shaders[i], pipeline->program_indices[i],
+				qs->shaders[i] = pipeline->shaders[i];
+				glBeginQuery(GL_TIME_ELAPSED, qs->queries[i]);
+				do_compute_shader(ctx, worker, cp, frame, pipeline->shaders[i], pipeline->program_indices[i],
 				                  pipeline->parameters + i, *arena);
 				glEndQuery(GL_TIME_ELAPSED);
 			}
 
-			/* NOTE(rnp): the first of these blocks until work completes */
-			for (u32 i = 0; i < pipeline->shader_count; i++) {
-				ComputeTimingInfo info = {0};
-				info.kind   = ComputeTimingInfoKind_Shader;
-				info.shader = pipeline->shaders[i];
-				glGetQueryObjectui64v(cc->shader_timer_ids[i], GL_QUERY_RESULT, &info.timer_count);
-				push_compute_timing_info(ctx->compute_timing_table, info);
+			worker->timer_query_write_index++;
+
+			/* NOTE(rnp): the frame is sampled from other contexts; they wait on its
+			 * fence on the GPU instead of this worker blocking until it completes */
+			beamformer_frame_fence(worker, frame);
+			if (did_sum_shader) {
+				u32 aframe_index = (cp->averaged_frame_index % countof(cp->averaged_frames));
+				beamformer_frame_fence(worker, cp->averaged_frames + aframe_index);
 			}
-			cs->processing_progress = 1;
+			glFlush();
+			worker->processing_progress = 1;
 
-			frame->ready_to_present = 1;
+			atomic_store_u32(&frame->ready_to_present, 1);
+			BeamformerFrame *presented = frame;
 			if (did_sum_shader) {
-				u32 aframe_index = (ctx->averaged_frame_index % countof(ctx->averaged_frames));
-				ctx->averaged_frames[aframe_index].view_plane_tag  = frame->view_plane_tag;
-				ctx->averaged_frames[aframe_index].ready_to_present = 1;
-				atomic_add_u32(&ctx->averaged_frame_index, 1);
-				atomic_store_u64((u64 *)&ctx->latest_frame, (u64)(ctx->averaged_frames + aframe_index));
-			} else {
-				atomic_store_u64((u64 *)&ctx->latest_frame, (u64)frame);
+				u32 aframe_index = (cp->averaged_frame_index % countof(cp->averaged_frames));
+				cp->averaged_frames[aframe_index].view_plane_tag  = frame->view_plane_tag;
+				cp->averaged_frames[aframe_index].ready_to_present = 1;
+				cp->averaged_frame_index++;
+				presented = cp->averaged_frames + aframe_index;
 			}
-			cs->processing_compute  = 0;
+			/* NOTE(rnp): the latest frame stays pinned until a newer one replaces it */
+			beamformer_frame_cache_lock(&ctx->frame_cache);
+			if (ctx->latest_frame) ctx->latest_frame->pins--;
+			presented->pins++;
+			atomic_store_u64((u64 *)&ctx->latest_frame, (u64)presented);
+			beamformer_frame_cache_unlock(&ctx->frame_cache);
+
+			if (atomic_load_u32(&sm->export_stream_enabled))
+				beamformer_export_stream_push(ctx, worker, presented, cwc->parameter_block);
+
+			beamformer_collect_timer_queries(cc, worker, ctx->compute_timing_table, 0);
+			beamformer_signal_frames_completed(sm, cwc->parameter_block, 1);
+		}
+		atomic_store_u32(&worker->processing_compute, 0);
 
-			push_compute_timing_info(ctx->compute_timing_table,
-			                         (ComputeTimingInfo){.kind = ComputeTimingInfoKind_ComputeFrameEnd});
+		end_renderdoc_capture(gl_context);
+	}break;
+	InvalidDefaultCase;
+	}
+
+	return can_commit;
+}
+
+function void
+beamformer_compute_workers_wait_idle(BeamformerComputeContext *cc)
+{
+	/* NOTE(rnp): work is only removed from a worker's queue once it has been completed */
+	for (u32 i = 1; i < cc->worker_count; i++)
+		spin_wait(beamform_work_queue_pop(cc->workers[i].queue));
+}
 
-			end_renderdoc_capture(gl_context);
+/* NOTE(rnp): RF slots must be consumed in the order they were filled. this is decided here,
+ * in submission order, instead of by whichever worker happens to get there first */
+function void
+beamformer_assign_rf_slot(BeamformerRFBuffer *rf, BeamformWork *work)
+{
+	BeamformerComputeWorkContext *cwc = &work->compute_context;
+
+	for (;;) {
+		BeamformerRFRingState ring = {.value = atomic_load_u64(&rf->ring.value)};
+		u32 slot = ring.compute_index % ring.depth;
+
+		/* NOTE(rnp): compute indirect is used when uploading data; its upload will land in the
+		 * next slot even if it hasn't yet. plain compute picks up an upload if one is waiting */
+		b32 upload = work->kind == BeamformerWorkKind_ComputeIndirect;
+		if (!upload && atomic_load_u64(rf->upload_syncs + slot))
+			upload = atomic_load_u32(rf->upload_sequence + slot) == ring.compute_index;
+
+		if (upload) cwc->flags |=  BeamformerComputeWorkFlags_RFUpload;
+		else        cwc->flags &= (u8)~BeamformerComputeWorkFlags_RFUpload;
+		if (upload) {
+			BeamformerRFRingState next = ring;
+			next.compute_index++;
+			/* NOTE(rnp): lost a race with the upload thread changing the depth */
+			if (!atomic_cas_u64(&rf->ring.value, &ring.value, next.value))
+				continue;
+			cwc->rf_slot          = (u8)slot;
+			cwc->rf_sequence      = ring.compute_index;
+			rf->last_compute_slot = slot;
+		} else {
+			cwc->rf_slot          = (u8)rf->last_compute_slot;
+		}
+		break;
+	}
+}
+
+/* NOTE(rnp): true if compute indirect for the same parameter block is queued behind the
+ * work at the head of the queue. exports stop the search since they expect the frame
+ * before them to have been computed */
+function b32
+beamform_work_queue_has_newer_compute(BeamformWorkQueue *q, u32 parameter_block)
+{
+	u32 mask = countof(q->entries) - 1;
+
+	b32 result = 0;
+	for (u32 index = atomic_load_u32(&q->read_index) + 1; !result; index++) {
+		BeamformWorkQueueEntry *e = q->entries + (index & mask);
+		/* NOTE(rnp): stop at the first entry which hasn't been committed */
+		if (atomic_load_u32(&e->sequence) != (index & ~mask) + 1)
+			break;
+		BeamformWork *work = &e->work;
+		if (work->kind == BeamformerWorkKind_ExportBuffer)
+			break;
+		result = work->kind == BeamformerWorkKind_ComputeIndirect &&
+		         work->compute_indirect_context.parameter_block == parameter_block;
+	}
+	return result;
+}
+
+/* NOTE(rnp): only the first worker reads the shared queues. work for parameter blocks owned
+ * by another worker is handed off to that worker's queue; everything else is done in place */
+function void
+dispatch_queue(BeamformerCtx *ctx, BeamformerComputeWorker *worker, BeamformWorkQueue *q,
+               Arena *arena, iptr gl_context)
+{
+	BeamformerComputeContext *cc = &ctx->compute_context;
+	BeamformerSharedMemory   *sm = ctx->shared_memory.region;
+
+	BeamformWork *work = beamform_work_queue_pop(q);
+	while (work) {
+		BeamformerComputeWorker *owner = worker;
+		switch (work->kind) {
+		case BeamformerWorkKind_ReloadShader:
+		case BeamformerWorkKind_ExportBuffer:
+		{
+			/* NOTE(rnp): these touch state shared by every worker */
+			beamformer_compute_workers_wait_idle(cc);
+		}break;
+		case BeamformerWorkKind_CreateFilter:{
+			owner = beamformer_compute_worker_for_block(cc, work->create_filter_context.parameter_block);
+		}break;
+		case BeamformerWorkKind_ComputeIndirect:{
+			/* NOTE(rnp): when acquisition outruns the beamformer only the newest frame for
+			 * each block is worth computing. stale frames still consume their RF slot but
+			 * don't take a frame id so that averaging windows remain contiguous */
+			u32 block = work->compute_indirect_context.parameter_block;
+			if (atomic_load_u32(&sm->live_imaging_parameters.active) &&
+			    beamform_work_queue_has_newer_compute(q, block))
+			{
+				work->lock            = BeamformerSharedMemoryLockKind_DispatchCompute;
+				work->compute_context = (BeamformerComputeWorkContext){
+					.parameter_block = (u8)block,
+					.flags           = BeamformerComputeWorkFlags_Dropped,
+				};
+			} else {
+				fill_frame_compute_work(ctx, work, work->compute_indirect_context.view_plane, block, 1);
+			}
+		} /* FALLTHROUGH */
+		case BeamformerWorkKind_Compute:{
+			if (q != ctx->beamform_work_queue)
+				work->compute_context.flags |= BeamformerComputeWorkFlags_External;
+			beamformer_assign_rf_slot(&cc->rf_buffer, work);
+			owner = beamformer_compute_worker_for_block(cc, work->compute_context.parameter_block);
 		}break;
 		InvalidDefaultCase;
 		}
 
+		b32 can_commit = 1;
+		if (owner == worker) {
+			can_commit = complete_work(ctx, worker, q, work, arena, gl_context);
+		} else {
+			spin_wait(!beamform_work_queue_push_copy(owner->queue, q, work));
+			os_wake_waiters(&owner->thread->sync_variable);
+		}
+
 		if (can_commit) {
 			beamform_work_queue_pop_commit(q);
 			work = beamform_work_queue_pop(q);
@@ -1275,6 +2204,16 @@ complete_queue(BeamformerCtx *ctx, BeamformWorkQueue *q, Arena *arena, iptr gl_c
 	}
 }
 
+function void
+complete_queue(BeamformerCtx *ctx, BeamformerComputeWorker *worker, Arena *arena, iptr gl_context)
+{
+	BeamformWorkQueue *q = worker->queue;
+	for (BeamformWork *work = beamform_work_queue_pop(q); work; work = beamform_work_queue_pop(q)) {
+		complete_work(ctx, worker, q, work, arena, gl_context);
+		beamform_work_queue_pop_commit(q);
+	}
+}
+
 function void
 coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 {
@@ -1306,6 +2245,17 @@ coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 			stats->table.times[stats_index][info.shader] += (f32)info.timer_count / 1.0e9f;
 			seen_info_test |= (1u << info.shader);
 		}break;
+		case ComputeTimingInfoKind_DroppedFrame:{
+			stats->table.dropped_frames++;
+		}break;
+		case ComputeTimingInfoKind_RFUploadSyncWait:{
+			stats->table.rf_upload_sync_waits++;
+			stats->table.rf_upload_sync_wait_time += (f32)info.timer_count / 1.0e9f;
+		}break;
+		case ComputeTimingInfoKind_RFComputeSyncWait:{
+			stats->table.rf_compute_sync_waits++;
+			stats->table.rf_compute_sync_wait_time += (f32)info.timer_count / 1.0e9f;
+		}break;
 		case ComputeTimingInfoKind_RF_Data:{
 			stats->latest_rf_index = (stats->latest_rf_index + 1) % countof(stats->table.rf_time_deltas);
 			f32 delta = (f32)(info.timer_count - stats->last_rf_timer_count) / 1.0e9f;
@@ -1339,10 +2289,22 @@ coalesce_timing_table(ComputeTimingTable *t, ComputeShaderStats *stats)
 
 DEBUG_EXPORT BEAMFORMER_COMPLETE_COMPUTE_FN(beamformer_complete_compute)
 {
-	BeamformerCtx *ctx         = (BeamformerCtx *)user_context;
-	BeamformerSharedMemory *sm = ctx->shared_memory.region;
-	complete_queue(ctx, &sm->external_work_queue, arena, gl_context);
-	complete_queue(ctx, ctx->beamform_work_queue, arena, gl_context);
+	BeamformerComputeWorker *worker = (BeamformerComputeWorker *)user_context;
+	BeamformerCtx           *ctx    = worker->beamformer;
+	BeamformerSharedMemory  *sm     = ctx->shared_memory.region;
+	if (worker->index == 0) {
+		/* NOTE(rnp): see beamformer_invalidate_shared_memory(); outstanding client work is dropped */
+		if (atomic_load_u32(&sm->invalid)) {
+			while (beamform_work_queue_pop(&sm->external_work_queue))
+				beamform_work_queue_pop_commit(&sm->external_work_queue);
+		}
+		dispatch_queue(ctx, worker, &sm->external_work_queue, arena, gl_context);
+		dispatch_queue(ctx, worker, ctx->beamform_work_queue, arena, gl_context);
+	} else {
+		complete_queue(ctx, worker, arena, gl_context);
+	}
+	/* NOTE(rnp): the worker only sleeps briefly while readbacks are outstanding (see static.c) */
+	beamformer_collect_readbacks(ctx, worker, 0);
 }
 
 function void
@@ -1353,64 +2315,261 @@ beamformer_rf_buffer_allocate(BeamformerRFBuffer *rf, u32 rf_size, Arena arena)
 	glDeleteBuffers(1, &rf->ssbo);
 	glCreateBuffers(1, &rf->ssbo);
 
-	glNamedBufferStorage(rf->ssbo, countof(rf->compute_syncs) * rf_size, 0,
-	                     GL_DYNAMIC_STORAGE_BIT|GL_MAP_WRITE_BIT);
+	glNamedBufferStorage(rf->ssbo, (iz)rf->ring.depth * rf_size, 0, GL_DYNAMIC_STORAGE_BIT|GL_MAP_WRITE_BIT);
 	LABEL_GL_OBJECT(GL_BUFFER, rf->ssbo, s8("Raw_RF_SSBO"));
 	rf->size = rf_size;
 }
 
+function u32
+beamformer_rf_ring_wanted_depth(BeamformerRFBuffer *rf, u32 slot_size)
+{
+	u32 result = rf->requested_depth;
+	if (result == 0) {
+		u64 fit = rf->memory_budget / MAX(slot_size, 1);
+		result  = (u32)CLAMP(fit, BeamformerMaxRawDataFramesInFlight, BEAMFORMER_RF_RING_MAX_DEPTH);
+	}
+	return result;
+}
+
+/* NOTE(rnp): the depth can only change while no upload is waiting for its compute and the
+ * compute side isn't ahead of the uploads; otherwise try again on a later upload */
+function b32
+beamformer_rf_ring_try_resize(BeamformerRFBuffer *rf, u32 depth)
+{
+	b32 result = 1;
+	for (u32 i = 0; i < rf->ring.depth && result; i++)
+		result = atomic_load_u64(rf->upload_syncs + i) == 0;
+
+	if (result) {
+		BeamformerRFRingState ring = {.compute_index = rf->insertion_index, .depth = rf->ring.depth};
+		BeamformerRFRingState next = {.compute_index = rf->insertion_index, .depth = depth};
+		result = atomic_cas_u64(&rf->ring.value, &ring.value, next.value);
+	}
+
+	if (result) {
+		for EachElement(rf->compute_syncs, i) {
+			if (rf->compute_syncs[i]) {
+				glClientWaitSync(rf->compute_syncs[i], 0, GL_TIMEOUT_IGNORED);
+				glDeleteSync(rf->compute_syncs[i]);
+				rf->compute_syncs[i] = 0;
+			}
+		}
+	}
+	return result;
+}
+
+typedef struct {
+	u8  *buffer;
+	u32  slot;
+	u32  sequence;
+	u32  size;
+	u32  frame_count;
+} BeamformerRFUploadMapping;
+
+function u64
+beamformer_timer_counter_to_ns(u64 count)
+{
+	u64 result = (u64)((f64)count * 1.0e9 / (f64)os_get_timer_frequency());
+	return result;
+}
+
+function BeamformerRFUploadMapping
+beamformer_rf_upload_map(BeamformerRFBuffer *rf, ComputeTimingTable *timing_table, u32 frame_size,
+                         u32 frame_count, Arena arena)
+{
+	BeamformerRFUploadMapping result = {.frame_count = MAX(1, frame_count)};
+	rf->active_rf_size      = (u32)round_up_to(frame_size, 64);
+	rf->active_frame_stride = rf->active_rf_size;
+	/* NOTE(rnp): 256 is the largest SSBO binding offset alignment allowed by GL */
+	if (result.frame_count > 1)
+		rf->active_frame_stride = (u32)round_up_to(rf->active_rf_size, 256);
+
+	result.size = (u32)round_up_to(rf->active_frame_stride * result.frame_count, 256);
+
+	u32 depth = beamformer_rf_ring_wanted_depth(rf, result.size);
+	if (depth != rf->ring.depth && beamformer_rf_ring_try_resize(rf, depth)) {
+		beamformer_rf_buffer_allocate(rf, MAX(rf->size, result.size), arena);
+	} else if (rf->size < result.size) {
+		beamformer_rf_buffer_allocate(rf, result.size, arena);
+	}
+
+	result.sequence = rf->insertion_index++;
+	result.slot     = result.sequence % rf->ring.depth;
+
+	/* NOTE(rnp): if the rest of the code is functioning then the first
+	 * time the compute thread processes an upload it must have gone
+	 * through this path. therefore it is safe to spin until it gets processed */
+	if (atomic_load_u64(rf->upload_syncs + result.slot)) {
+		u64 start = os_get_timer_counter();
+		spin_wait(atomic_load_u64(rf->upload_syncs + result.slot));
+		push_compute_timing_info(timing_table, (ComputeTimingInfo){
+			.kind        = ComputeTimingInfoKind_RFUploadSyncWait,
+			.timer_count = beamformer_timer_counter_to_ns(os_get_timer_counter() - start),
+		});
+	}
+
+	if (rf->compute_syncs[result.slot]) {
+		GLenum sync_result = glClientWaitSync(rf->compute_syncs[result.slot], 0, 0);
+		if (sync_result == GL_TIMEOUT_EXPIRED) {
+			u64 start   = os_get_timer_counter();
+			sync_result = glClientWaitSync(rf->compute_syncs[result.slot], 0, 1000000000);
+			push_compute_timing_info(timing_table, (ComputeTimingInfo){
+				.kind        = ComputeTimingInfoKind_RFComputeSyncWait,
+				.timer_count = beamformer_timer_counter_to_ns(os_get_timer_counter() - start),
+			});
+		}
+		if (sync_result == GL_TIMEOUT_EXPIRED || sync_result == GL_WAIT_FAILED) {
+			// TODO(rnp): what do?
+		}
+		glDeleteSync(rf->compute_syncs[result.slot]);
+	}
+
+	/* NOTE(rnp): nVidia's drivers really don't play nice with persistant mapping,
+	 * at least when it is a big as this one wants to be. mapping and unmapping the
+	 * desired range each time doesn't seem to introduce any performance hit */
+	u32 access = GL_MAP_WRITE_BIT|GL_MAP_FLUSH_EXPLICIT_BIT|GL_MAP_UNSYNCHRONIZED_BIT;
+	result.buffer = glMapNamedBufferRange(rf->ssbo, (iz)result.slot * rf->size, (i32)result.size, access);
+	return result;
+}
+
+function void
+beamformer_rf_upload_copy_frames(BeamformerUploadThreadContext *ctx, BeamformerRFUploadMapping *m,
+                                 u8 *data, u32 frame_size)
+{
+	BeamformerRFBuffer *rf = ctx->rf_buffer;
+	/* NOTE(rnp): frames are packed in shared memory but need to be aligned in the SSBO */
+	if (m->frame_count == 1 || rf->active_frame_stride == frame_size) {
+		memory_copy(ctx->copy_engine, m->buffer, data, (uz)rf->active_frame_stride * (m->frame_count - 1) +
+		                                               rf->active_rf_size);
+	} else {
+		for (u32 i = 0; i < m->frame_count; i++) {
+			memory_copy(ctx->copy_engine, m->buffer + i * rf->active_frame_stride,
+			            data + (uz)i * frame_size, rf->active_rf_size);
+		}
+	}
+}
+
+/* NOTE(rnp): encoded data is expanded straight into the mapped range */
+function void
+beamformer_rf_upload_frames(BeamformerUploadThreadContext *ctx, BeamformerRFUploadMapping *m, u8 *data,
+                            u32 frame_size, BeamformerRFEncoding encoding, u32 encoded_size)
+{
+	if (encoding == BeamformerRFEncoding_None) {
+		beamformer_rf_upload_copy_frames(ctx, m, data, frame_size);
+	} else {
+		rf_decode(encoding, (i16 *)m->buffer, frame_size / sizeof(i16), data, encoded_size);
+	}
+}
+
+function void
+beamformer_rf_upload_commit(BeamformerUploadThreadContext *ctx, BeamformerRFUploadMapping *m)
+{
+	BeamformerRFBuffer *rf = ctx->rf_buffer;
+	glFlushMappedNamedBufferRange(rf->ssbo, 0, (i32)m->size);
+	glUnmapNamedBuffer(rf->ssbo);
+
+	rf->frame_counts[m->slot]    = m->frame_count;
+	rf->frame_sizes[m->slot]     = rf->active_rf_size;
+	rf->frame_strides[m->slot]   = rf->active_frame_stride;
+	rf->upload_sequence[m->slot] = m->sequence;
+	memory_write_barrier();
+	rf->upload_syncs[m->slot]    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	rf->compute_syncs[m->slot]   = 0;
+	memory_write_barrier();
+
+	os_wake_waiters(ctx->compute_worker_sync);
+
+	if (rf->data_timestamp_write_index - rf->data_timestamp_read_index == countof(rf->data_timestamp_queries))
+		beamformer_collect_timestamp_queries(rf, ctx->compute_timing_table, 1);
+	u32 query = rf->data_timestamp_write_index++ % countof(rf->data_timestamp_queries);
+	glQueryCounter(rf->data_timestamp_queries[query], GL_TIMESTAMP);
+	beamformer_collect_timestamp_queries(rf, ctx->compute_timing_table, 0);
+}
+
+function b32
+beamformer_rf_slot_ready(BeamformerSharedMemory *sm)
+{
+	u32 index  = atomic_load_u32(&sm->rf_slot_read_index) % BEAMFORMER_RF_SLOT_COUNT;
+	b32 result = atomic_load_u32(&sm->rf_slots[index].state) == BeamformerRFSlotState_Ready;
+	return result;
+}
+
+/* NOTE(rnp): slot and scratch headers are written by clients so the sizes are checked against
+ * what can be read from shared memory and what the ring's u32 sizes can describe */
+function b32
+beamformer_rf_upload_size_valid(u32 frame_size, u32 frame_count, u64 capacity)
+{
+	u64 count  = MAX(1, frame_count);
+	u64 stride = (u64)round_up_to(round_up_to(frame_size, 64), 256);
+	b32 result = frame_size > 0 && (u64)frame_size * count + 64 <= capacity &&
+	             (u64)round_up_to((iz)(stride * count), 256) <= U32_MAX;
+	return result;
+}
+
+/* NOTE(rnp): a compute may already be queued for the upload so its place in the ring is still
+ * used up. a frame count of 0 tells the compute there is nothing to beamform */
+function void
+beamformer_rf_upload_reject(BeamformerUploadThreadContext *ctx, Arena arena)
+{
+	BeamformerRFBuffer *rf = ctx->rf_buffer;
+	BeamformerRFUploadMapping m = beamformer_rf_upload_map(rf, ctx->compute_timing_table,
+	                                                       MAX(64, rf->active_rf_size), 1, arena);
+	m.frame_count = 0;
+	beamformer_rf_upload_commit(ctx, &m);
+}
+
 DEBUG_EXPORT BEAMFORMER_RF_UPLOAD_FN(beamformer_rf_upload)
 {
 	BeamformerSharedMemory *sm = ctx->shared_memory->region;
+	BeamformerRFBuffer     *rf = ctx->rf_buffer;
 
 	BeamformerSharedMemoryLockKind scratch_lock = BeamformerSharedMemoryLockKind_ScratchSpace;
 	BeamformerSharedMemoryLockKind upload_lock  = BeamformerSharedMemoryLockKind_UploadRF;
 	if (sm->locks[upload_lock] &&
 	    os_shared_memory_region_lock(ctx->shared_memory, sm->locks, (i32)scratch_lock, (u32)-1))
 	{
-		BeamformerRFBuffer *rf = ctx->rf_buffer;
-		rf->active_rf_size = (u32)round_up_to(sm->scratch_rf_size, 64);
-		if (rf->size < rf->active_rf_size)
-			beamformer_rf_buffer_allocate(rf, rf->active_rf_size, arena);
-
-		u32 slot = rf->insertion_index++ % countof(rf->compute_syncs);
-
-		/* NOTE(rnp): if the rest of the code is functioning then the first
-		 * time the compute thread processes an upload it must have gone
-		 * through this path. therefore it is safe to spin until it gets processed */
-		spin_wait(atomic_load_u64(rf->upload_syncs + slot));
-
-		if (rf->compute_syncs[slot]) {
-			GLenum sync_result = glClientWaitSync(rf->compute_syncs[slot], 0, 1000000000);
-			if (sync_result == GL_TIMEOUT_EXPIRED || sync_result == GL_WAIT_FAILED) {
-				// TODO(rnp): what do?
-			}
-			glDeleteSync(rf->compute_syncs[slot]);
+		Arena scratch   = beamformer_shared_memory_scratch_arena(sm);
+		u32 frame_size  = sm->scratch_rf_size;
+		u32 frame_count = sm->scratch_rf_frame_count;
+		if (beamformer_rf_upload_size_valid(frame_size, frame_count, (u64)arena_capacity(&scratch, u8))) {
+			BeamformerRFUploadMapping m = beamformer_rf_upload_map(rf, ctx->compute_timing_table,
+			                                                       frame_size, frame_count, arena);
+			u32 encoded_size = (u32)MIN(sm->scratch_rf_encoded_size, (u64)arena_capacity(&scratch, u8));
+			beamformer_rf_upload_frames(ctx, &m, scratch.beg, frame_size, sm->scratch_rf_encoding, encoded_size);
+			os_shared_memory_region_unlock(ctx->shared_memory, sm->locks, (i32)scratch_lock);
+			post_sync_barrier(ctx->shared_memory, upload_lock, sm->locks);
+			beamformer_rf_upload_commit(ctx, &m);
+		} else {
+			os_shared_memory_region_unlock(ctx->shared_memory, sm->locks, (i32)scratch_lock);
+			post_sync_barrier(ctx->shared_memory, upload_lock, sm->locks);
+			beamformer_rf_upload_reject(ctx, arena);
 		}
+	}
 
-		/* NOTE(rnp): nVidia's drivers really don't play nice with persistant mapping,
-		 * at least when it is a big as this one wants to be. mapping and unmapping the
-		 * desired range each time doesn't seem to introduce any performance hit */
-		u32 access = GL_MAP_WRITE_BIT|GL_MAP_FLUSH_EXPLICIT_BIT|GL_MAP_UNSYNCHRONIZED_BIT;
-		u8 *buffer = glMapNamedBufferRange(rf->ssbo, slot * rf->active_rf_size, (i32)rf->active_rf_size, access);
-
-		mem_copy(buffer, beamformer_shared_memory_scratch_arena(sm).beg, rf->active_rf_size);
-		os_shared_memory_region_unlock(ctx->shared_memory, sm->locks, (i32)scratch_lock);
-		post_sync_barrier(ctx->shared_memory, upload_lock, sm->locks);
-
-		glFlushMappedNamedBufferRange(rf->ssbo, 0, (i32)rf->active_rf_size);
-		glUnmapNamedBuffer(rf->ssbo);
-
-		rf->upload_syncs[slot]  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-		rf->compute_syncs[slot] = 0;
-		memory_write_barrier();
-
-		os_wake_waiters(ctx->compute_worker_sync);
-
-		ComputeTimingInfo info = {.kind = ComputeTimingInfoKind_RF_Data};
-		glGetQueryObjectui64v(rf->data_timestamp_query, GL_QUERY_RESULT, &info.timer_count);
-		glQueryCounter(rf->data_timestamp_query, GL_TIMESTAMP);
-		push_compute_timing_info(ctx->compute_timing_table, info);
+	/* NOTE(rnp): slots are filled in place by the client so they go straight to the GPU.
+	 * they are consumed strictly in acquisition order to match the order in which their
+	 * computes were queued */
+	while (beamformer_rf_slot_ready(sm)) {
+		u32 index = atomic_load_u32(&sm->rf_slot_read_index) % BEAMFORMER_RF_SLOT_COUNT;
+		BeamformerRFSlot *slot = sm->rf_slots + index;
+
+		u32 frame_size  = slot->frame_size;
+		u32 frame_count = slot->frame_count;
+		if (beamformer_rf_upload_size_valid(frame_size, frame_count, BEAMFORMER_RF_SLOT_SIZE)) {
+			BeamformerRFUploadMapping m = beamformer_rf_upload_map(rf, ctx->compute_timing_table,
+			                                                       frame_size, frame_count, arena);
+			beamformer_rf_upload_frames(ctx, &m, beamformer_rf_slot_data(sm, index), frame_size,
+			                            slot->encoding, (u32)MIN(slot->encoded_size, BEAMFORMER_RF_SLOT_SIZE));
+
+			atomic_add_u32(&sm->rf_slot_read_index, 1);
+			os_wake_waiters(&slot->state);
+			beamformer_rf_upload_commit(ctx, &m);
+		} else {
+			/* NOTE(rnp): the slot is freed without touching its data */
+			atomic_add_u32(&sm->rf_slot_read_index, 1);
+			os_wake_waiters(&slot->state);
+			beamformer_rf_upload_reject(ctx, arena);
+		}
 	}
 }
 
@@ -1426,6 +2585,7 @@ DEBUG_EXPORT BEAMFORMER_FRAME_STEP_FN(beamformer_frame_step)
 	}
 
 	coalesce_timing_table(ctx->compute_timing_table, ctx->compute_shader_stats);
+	ctx->compute_shader_stats->table.rf_ring_depth = ctx->compute_context.rf_buffer.ring.depth;
 
 	if (input->executable_reloaded) {
 		ui_init(ctx, ctx->ui_backing_store);
@@ -1434,13 +2594,26 @@ DEBUG_EXPORT BEAMFORMER_FRAME_STEP_FN(beamformer_frame_step)
 	}
 
 	BeamformerSharedMemory *sm = ctx->shared_memory.region;
-	if (sm->locks[BeamformerSharedMemoryLockKind_UploadRF] != 0)
+	if (sm->locks[BeamformerSharedMemoryLockKind_UploadRF] != 0 || beamformer_rf_slot_ready(sm))
 		os_wake_waiters(&ctx->os.upload_worker.sync_variable);
 
-	BeamformerFrame        *frame = ctx->latest_frame;
-	BeamformerViewPlaneTag  tag   = frame? frame->view_plane_tag : 0;
+	/* NOTE(rnp): hold a pin while drawing; draw_ui() pins the frames the ui keeps */
+	BeamformerFrameCache *fc = &ctx->frame_cache;
+	beamformer_frame_cache_lock(fc);
+	BeamformerFrame *frame = ctx->latest_frame;
+	if (frame) frame->pins++;
+	beamformer_frame_cache_unlock(fc);
+
+	BeamformerViewPlaneTag tag = frame? frame->view_plane_tag : 0;
+	if (frame) beamformer_frame_wait(frame);
 	draw_ui(ctx, input, frame, tag);
 
+	if (frame) {
+		beamformer_frame_cache_lock(fc);
+		frame->pins--;
+		beamformer_frame_cache_unlock(fc);
+	}
+
 	ctx->frame_view_render_context.updated = 0;
 
 	if (WindowShouldClose())
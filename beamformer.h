@@ -15,10 +15,15 @@
 function OS_READ_WHOLE_FILE_FN(os_read_whole_file);
 function OS_SHARED_MEMORY_LOCK_REGION_FN(os_shared_memory_region_lock);
 function OS_SHARED_MEMORY_UNLOCK_REGION_FN(os_shared_memory_region_unlock);
+function OS_WAIT_ON_VALUE_FN(os_wait_on_value);
 function OS_WAKE_WAITERS_FN(os_wake_waiters);
+function void os_wake_all_waiters(i32 *value);
 function OS_WRITE_FILE_FN(os_write_file);
+function u64 os_get_timer_counter(void);
+function u64 os_get_timer_frequency(void);
 
 #include "util_gl.c"
+#include "memory_copy.c"
 
 enum gl_vendor_ids {
 	GL_VENDOR_AMD,
@@ -34,6 +39,23 @@ typedef struct {
 	f32  dt;
 } BeamformerInput;
 
+/* NOTE: options which can be passed on the command line */
+typedef struct {
+	u32 compute_workers;
+	u32 rf_ring_depth;
+	u32 copy_helpers;
+	u64 copy_threshold;
+	/* NOTE(rnp): 0 sizes the frame cache from GPU memory */
+	u64 frame_cache_budget;
+	char *replay_path;
+	u64   replay_rate;
+	char *listen_address;
+
+	u64 shared_memory_size;
+	/* NOTE(rnp): OSSharedMemoryFlags */
+	u32 shared_memory_flags;
+} BeamformerOptions;
+
 #define CUDA_INIT_FN(name) void name(u32 *input_dims, u32 *decoded_dims)
 typedef CUDA_INIT_FN(cuda_init_fn);
 CUDA_INIT_FN(cuda_init_stub) {}
@@ -90,6 +112,7 @@ typedef struct {
 } FrameViewRenderContext;
 
 #include "beamformer_parameters.h"
+#include "rf_encoding.c"
 #include "beamformer_shared_memory.c"
 
 typedef struct {
@@ -195,6 +218,67 @@ typedef enum {
 static_assert((BeamformerComputeTextureKind_Count - 1) == BeamformerComputeTextureKind_Hadamard,
               "BeamformerComputeTextureKind_Hadamard must be end of TextureKinds");
 
+/* NOTE: interstage buffers are handed out in size classes so that a buffer released by
+ * one compute plan can be picked up by another without being reallocated */
+#define BEAMFORMER_BUFFER_POOL_MIN_SIZE   KB(64)
+#define BEAMFORMER_BUFFER_POOL_FREE_SLOTS 16
+typedef struct {
+	u32 buffer;
+	u64 size;
+} BeamformerPooledBuffer;
+
+typedef struct {
+	BeamformerPooledBuffer free_buffers[BEAMFORMER_BUFFER_POOL_FREE_SLOTS];
+	u32 free_count;
+	u32 allocated_count;
+	u64 allocated_bytes;
+	u64 free_bytes;
+} BeamformerBufferPool;
+
+struct BeamformerFrame {
+	u32 texture;
+	b32 ready_to_present;
+	/* NOTE(rnp): signals when the producing context's writes have landed. readers on other
+	 * contexts count themselves in sync_readers while using it; only the worker producing
+	 * into the frame retires it and only once no reader holds it */
+	GLsync sync;
+	u32    sync_readers;
+	/* NOTE(rnp): frames someone still points to (the latest frame, the ui's planes); the
+	 * frame cache never releases or reuses a pinned frame. changed under the cache lock */
+	u32 pins;
+
+	iv3 dim;
+	i32 mips;
+
+	/* NOTE: for use when displaying either prebeamformed frames or on the current frame
+	 * when we intend to recompute on the next frame */
+	v3  min_coordinate;
+	v3  max_coordinate;
+
+	// metadata
+	GLenum                 gl_kind;
+	u32                    id;
+	u32                    compound_count;
+	BeamformerDASKind      das_kind;
+	BeamformerViewPlaneTag view_plane_tag;
+
+	BeamformerFrame *next;
+};
+
+/* NOTE: full precision running sum used by the Incremental and Exponential sum modes. frame
+ * ids are shared by every plan and skipped by dropped frames so the frames which were summed
+ * in are remembered; a slot only still holds one of them if its id matches */
+typedef struct {
+	BeamformerFrame   frame;
+	BeamformerSumMode mode;
+	u32               window;
+	u32               count;
+
+	BeamformerFrame  *summed_frames[BeamformerMaxSavedFrames];
+	u32               summed_frame_ids[BeamformerMaxSavedFrames];
+	u32               summed_frame_count;
+} BeamformerAverageAccumulator;
+
 typedef struct BeamformerComputePlan BeamformerComputePlan;
 struct BeamformerComputePlan {
 	BeamformerComputePipeline pipeline;
@@ -206,6 +290,12 @@ struct BeamformerComputePlan {
 	i32 hadamard_order;
 	b32 iq_pipeline;
 
+	/* NOTE(rnp): measured from the DAS timer query; used for dispatch pacing */
+	u32 das_dispatch_count;
+	u64 das_dispatch_time_ns;
+
+	BeamformerDataKind output_data_kind;
+
 	v3  min_coordinate;
 	v3  max_coordinate;
 	iv3 output_points;
@@ -216,6 +306,15 @@ struct BeamformerComputePlan {
 
 	BeamformerFilter filters[BeamformerFilterSlots];
 
+	/* NOTE(rnp): two interstage buffers are used so that data may be ping ponged
+	 * between compute stages */
+	BeamformerPooledBuffer interstage_buffers[2];
+
+	/* NOTE: only used when averaging; kept per plan since blocks may run concurrently */
+	u32                          averaged_frame_index;
+	BeamformerFrame              averaged_frames[2];
+	BeamformerAverageAccumulator average_accumulator;
+
 	#define X(k, type, name) type name ##_ubo_data;
 	BEAMFORMER_COMPUTE_UBO_LIST
 	#undef X
@@ -223,39 +322,155 @@ struct BeamformerComputePlan {
 	BeamformerComputePlan *next;
 };
 
+/* NOTE: number of frames worth of GPU timer queries that may be waiting for readback */
+#define BEAMFORMER_TIMER_QUERY_RING_SIZE 4
+
+typedef struct {
+	u32                  queries[BeamformerMaxComputeShaderStages];
+	BeamformerShaderKind shaders[BeamformerMaxComputeShaderStages];
+	u32                  shader_count;
+	u32                  parameter_block;
+} BeamformerTimerQuerySet;
+
+/* NOTE: long running shaders are split into many dispatches so that no single submission
+ * trips the OS's GPU watchdog. instead of draining the GPU before each dispatch only enough
+ * dispatches to fill the budget (based on the measured time per dispatch) are kept in flight */
+#define BEAMFORMER_DISPATCH_BUDGET_NS        (50ULL * 1000ULL * 1000ULL)
+#define BEAMFORMER_MAX_DISPATCHES_IN_FLIGHT  16
+typedef struct {
+	GLsync syncs[BEAMFORMER_MAX_DISPATCHES_IN_FLIGHT];
+	u32    allowed_in_flight;
+	u32    submitted;
+} BeamformerDispatchPacer;
+
+/* NOTE: the RF ring depth is chosen at runtime. by default it is however many slots of the
+ * current upload size fit in 1/BEAMFORMER_RF_RING_MEMORY_SHARE of GPU memory, but never
+ * fewer than BeamformerMaxRawDataFramesInFlight */
+#define BEAMFORMER_RF_RING_MAX_DEPTH    (16)
+#define BEAMFORMER_RF_RING_MEMORY_SHARE (8)
+static_assert(BEAMFORMER_RF_RING_MAX_DEPTH <= 255, "BeamformerComputeWorkContext stores RF slots in a u8");
+
+/* NOTE(rnp): slots are picked with sequence % depth on both the upload and the compute side.
+ * the compute index and depth are swapped together so that the depth only changes when the
+ * compute side hasn't already picked a slot for an upload that hasn't happened yet */
+typedef union {
+	u64 value;
+	struct {
+		u32 compute_index;
+		u32 depth;
+	};
+} BeamformerRFRingState;
+
 typedef struct {
-	GLsync upload_syncs[BeamformerMaxRawDataFramesInFlight];
-	GLsync compute_syncs[BeamformerMaxRawDataFramesInFlight];
+	GLsync upload_syncs[BEAMFORMER_RF_RING_MAX_DEPTH];
+	GLsync compute_syncs[BEAMFORMER_RF_RING_MAX_DEPTH];
+
+	/* NOTE(rnp): frames uploaded together share a slot; each frame starts at a multiple of
+	 * frame_strides[slot] from the start of the slot. sizes and strides are recorded per slot
+	 * since active_rf_size/active_frame_stride follow the most recent upload */
+	u32 frame_counts[BEAMFORMER_RF_RING_MAX_DEPTH];
+	u32 frame_sizes[BEAMFORMER_RF_RING_MAX_DEPTH];
+	u32 frame_strides[BEAMFORMER_RF_RING_MAX_DEPTH];
+	/* NOTE(rnp): value of insertion_index when the slot was filled. with multiple compute
+	 * workers this is how a worker knows the upload it is waiting for has landed */
+	u32 upload_sequence[BEAMFORMER_RF_RING_MAX_DEPTH];
 
 	u32 ssbo;
 	u32 size;
 	u32 active_rf_size;
+	u32 active_frame_stride;
+
+	/* NOTE(rnp): 0 sizes the ring from memory_budget */
+	u32 requested_depth;
+	u64 memory_budget;
 
-	u32 data_timestamp_query;
+	/* NOTE(rnp): timestamps are read back once available instead of stalling the upload */
+	u32 data_timestamp_queries[BEAMFORMER_TIMER_QUERY_RING_SIZE];
+	u32 data_timestamp_write_index;
+	u32 data_timestamp_read_index;
 
 	u32 insertion_index;
-	u32 compute_index;
+	BeamformerRFRingState ring;
+	/* NOTE(rnp): slot of the newest upload handed to a compute; used when recomputing */
+	u32 last_compute_slot;
 } BeamformerRFBuffer;
 
+/* NOTE: frames are read back into persistently mapped pixel pack buffers. the copy out of
+ * the buffer is done once its fence has signalled so the worker can go on to the next frame
+ * while the transfer is in flight. buffers only ever grow */
+#define BEAMFORMER_READBACK_RING_SIZE 4
+/* NOTE: how often an otherwise idle worker checks on its outstanding readbacks */
+#define BEAMFORMER_READBACK_POLL_MS   1
+
+#define BEAMFORMER_RETIRED_SYNC_COUNT (2 * BeamformerMaxSavedFrames)
+
+typedef enum {
+	BeamformerReadbackKind_ExportBuffer,
+	BeamformerReadbackKind_ExportStream,
+} BeamformerReadbackKind;
+
 typedef struct {
-	/* TODO(rnp): slightly oversized; remove non compute shaders from match vectors count */
-	u32                programs[beamformer_match_vectors_count];
-	BeamformerRFBuffer rf_buffer;
+	GLsync fence;
+	u32    pbo;
+	u32    capacity;
+	u8    *mapped;
+
+	BeamformerReadbackKind kind;
+	u32                    size;
+	/* NOTE(rnp): ExportBuffer: shared memory lock held until the data lands in scratch.
+	 * ExportStream: export slot being written */
+	u32                    target;
+} BeamformerReadback;
+
+typedef struct BeamformerCtx BeamformerCtx;
+
+/* NOTE: each worker owns a GL context and the parameter blocks where block % worker_count
+ * is equal to its index. blocks owned by different workers can then run concurrently */
+typedef struct {
+	GLWorkerThreadContext *thread;
+	BeamformerCtx         *beamformer;
+	BeamformWorkQueue     *queue;
+	u32                    index;
 
-	BeamformerComputePlan *compute_plans[BeamformerMaxParameterBlockSlots];
-	BeamformerComputePlan *compute_plan_freelist;
+	/* NOTE(rnp): uniform values are program state so programs can't be shared between
+	 * workers. slightly oversized; remove non compute shaders from match vectors count */
+	u32 programs[beamformer_match_vectors_count];
 
-	/* NOTE(rnp): two interstage ssbos are allocated so that they may be used to
-	 * ping pong data between compute stages */
-	u32 ping_pong_ssbos[2];
+	BeamformerBufferPool interstage_pool;
 	u32 last_output_ssbo_index;
 
-	u32 ping_pong_ssbo_size;
-
+	/* NOTE(rnp): only written by this worker; the ui combines them across workers */
 	f32 processing_progress;
 	b32 processing_compute;
+	u32 cycle_t;
+
+	BeamformerTimerQuerySet timer_query_sets[BEAMFORMER_TIMER_QUERY_RING_SIZE];
+	u32 timer_query_write_index;
+	u32 timer_query_read_index;
+
+	BeamformerReadback readbacks[BEAMFORMER_READBACK_RING_SIZE];
+	u32 readback_write_index;
+	u32 readback_read_index;
 
-	u32 shader_timer_ids[BeamformerMaxComputeShaderStages];
+	/* NOTE(rnp): frame fences this worker replaced which may still be in use by a reader */
+	GLsync           retired_syncs[BEAMFORMER_RETIRED_SYNC_COUNT];
+	BeamformerFrame *retired_sync_frames[BEAMFORMER_RETIRED_SYNC_COUNT];
+	u32              retired_sync_count;
+} BeamformerComputeWorker;
+
+typedef struct {
+	BeamformerRFBuffer rf_buffer;
+
+	BeamformerComputePlan *compute_plans[BeamformerMaxParameterBlockSlots];
+	BeamformerComputePlan *compute_plan_freelist;
+
+	BeamformerComputeWorker workers[OS_MAX_COMPUTE_WORKERS];
+	u32                     worker_count;
+
+	/* NOTE(rnp): the cuda library holds a single set of interstage buffers so they are
+	 * registered again whenever a plan other than the last one runs a cuda stage */
+	u32 cuda_registered_buffers[2];
+	u32 cuda_registered_rf_ssbo;
 
 	BeamformerRenderModel unit_cube_model;
 } BeamformerComputeContext;
@@ -277,6 +492,9 @@ typedef enum {
 	ComputeTimingInfoKind_ComputeFrameEnd,
 	ComputeTimingInfoKind_Shader,
 	ComputeTimingInfoKind_RF_Data,
+	ComputeTimingInfoKind_DroppedFrame,
+	ComputeTimingInfoKind_RFUploadSyncWait,
+	ComputeTimingInfoKind_RFComputeSyncWait,
 } ComputeTimingInfoKind;
 
 typedef struct {
@@ -299,29 +517,26 @@ typedef struct {
 	SharedMemoryRegion *shared_memory;
 	ComputeTimingTable *compute_timing_table;
 	i32                *compute_worker_sync;
+	MemoryCopyEngine   *copy_engine;
 } BeamformerUploadThreadContext;
 
-struct BeamformerFrame {
-	u32 texture;
-	b32 ready_to_present;
-
-	iv3 dim;
-	i32 mips;
-
-	/* NOTE: for use when displaying either prebeamformed frames or on the current frame
-	 * when we intend to recompute on the next frame */
-	v3  min_coordinate;
-	v3  max_coordinate;
-
-	// metadata
-	GLenum                 gl_kind;
-	u32                    id;
-	u32                    compound_count;
-	BeamformerDASKind      das_kind;
-	BeamformerViewPlaneTag view_plane_tag;
-
-	BeamformerFrame *next;
-};
+/* NOTE: beamformed frames are kept until the bytes committed to their textures would exceed
+ * the budget. past that point the oldest frame with a matching (dim, format) is reused in
+ * place and only if there is none are the oldest frames released to make room. this keeps
+ * many small 2D frames resident while bounding the number of large 3D frames */
+#define BEAMFORMER_FRAME_CACHE_DEFAULT_BUDGET GB(1)
+/* NOTE: unless --frame-cache-budget is given the budget is 1/BEAMFORMER_FRAME_CACHE_MEMORY_SHARE
+ * of GPU memory, or the default above when the driver doesn't report any */
+#define BEAMFORMER_FRAME_CACHE_MEMORY_SHARE   (4)
+typedef struct {
+	BeamformerFrame frames[BeamformerMaxSavedFrames];
+	u64 committed_bytes;
+	u64 budget;
+	u32 frame_count;
+	/* NOTE: compute workers acquire frames concurrently; frames which are still being
+	 * written (!ready_to_present) or are pinned are never handed out again */
+	u32 lock;
+} BeamformerFrameCache;
 
 #define GL_PARAMETERS \
 	X(MAJOR_VERSION,                   version_major,                   "")      \
@@ -341,9 +556,13 @@ typedef struct {
 	#define X(glname, name, suffix) i32 name;
 	GL_PARAMETERS
 	#undef X
+	/* NOTE: vendor specific, 0 when the driver doesn't expose it. AMD only reports free
+	 * memory. free memory is sampled once at startup */
+	i32 total_memory_kb;
+	i32 free_memory_kb;
 } GLParams;
 
-typedef struct {
+struct BeamformerCtx {
 	GLParams gl;
 
 	iv2 window_size;
@@ -369,15 +588,11 @@ typedef struct {
 
 	SharedMemoryRegion shared_memory;
 
-	BeamformerFrame beamform_frames[BeamformerMaxSavedFrames];
+	BeamformerFrameCache frame_cache;
 	BeamformerFrame *latest_frame;
 	u32 next_render_frame_index;
 	u32 display_frame_index;
-
-	/* NOTE: this will only be used when we are averaging */
-	u32             averaged_frame_index;
-	BeamformerFrame averaged_frames[2];
-} BeamformerCtx;
+};
 
 struct ShaderReloadContext {
 	BeamformerCtx       *beamformer_context;
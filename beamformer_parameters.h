@@ -5,9 +5,6 @@
  * [ ]: shader kinds have ballooned; shader stats table needs to be compressed
  * [ ]: Upload previously exported data for display. maybe this is a UI thing but doing it
  *      programatically would be nice.
- * [ ]: Add interface for multi frame upload. RF upload already uses an offset into SM so
- *      that part works fine. We just need a way of specify a multi frame upload. (Data must
- *      be organized for simple offset access per frame).
  */
 
 typedef struct {
@@ -15,6 +12,16 @@ typedef struct {
 	 * visualization method you want to use. the coalescing function wants both directions */
 	float times[32][BeamformerShaderKind_ComputeCount];
 	float rf_time_deltas[32];
+	/* NOTE(rnp): stale live imaging frames which were skipped instead of computed */
+	uint32_t dropped_frames;
+	/* NOTE(rnp): RF ring occupancy as seen by the upload thread. upload sync waits happen
+	 * when the slot being reused hasn't been picked up by a compute yet; compute sync waits
+	 * when the GPU is still reading it. times are totals in seconds */
+	uint32_t rf_ring_depth;
+	uint32_t rf_upload_sync_waits;
+	uint32_t rf_compute_sync_waits;
+	float    rf_upload_sync_wait_time;
+	float    rf_compute_sync_wait_time;
 } BeamformerComputeStatsTable;
 
 /* TODO(rnp): this is an absolute abuse of the preprocessor, but now is
@@ -63,6 +70,36 @@ typedef enum {
 	BeamformerDASKind_Count
 } BeamformerDASKind;
 
+/* X(type, id, pretty name) */
+#define BEAMFORMER_SUM_MODE_LIST \
+	X(Full,        0, "Full")        \
+	X(Incremental, 1, "Incremental") \
+	X(Exponential, 2, "Exponential")
+
+typedef enum {
+	#define X(type, id, ...) BeamformerSumMode_##type = id,
+	BEAMFORMER_SUM_MODE_LIST
+	#undef X
+	BeamformerSumMode_Count
+} BeamformerSumMode;
+
+/* NOTE(rnp): transport encodings for Int16 RF data. the upload thread expands them back to
+ * Int16 so the pipeline's data kind is unaffected. packed samples are sign extended from
+ * the given number of bits. DeltaBlocks is lossless for any Int16 data */
+/* X(type, id, bits per sample, pretty name) */
+#define BEAMFORMER_RF_ENCODING_LIST \
+	X(None,        0, 16, "None")          \
+	X(Packed12,    1, 12, "Packed 12-bit") \
+	X(Packed14,    2, 14, "Packed 14-bit") \
+	X(DeltaBlocks, 3,  0, "Delta Blocks")
+
+typedef enum {
+	#define X(type, id, ...) BeamformerRFEncoding_##type = id,
+	BEAMFORMER_RF_ENCODING_LIST
+	#undef X
+	BeamformerRFEncoding_Count
+} BeamformerRFEncoding;
+
 #define FILTER_LOCAL_SIZE_X 64
 #define FILTER_LOCAL_SIZE_Y  1
 #define FILTER_LOCAL_SIZE_Z  1
@@ -81,8 +118,25 @@ typedef enum {
 #define DAS_CYCLE_T_UNIFORM_LOC       3
 #define DAS_FAST_CHANNEL_UNIFORM_LOC  4
 
-#define MIN_MAX_MIPS_LEVEL_UNIFORM_LOC 1
+/* NOTE(rnp): each MinMax dispatch writes up to log2(MIN_MAX_LOCAL_SIZE) + 1 mip levels */
+#define MIN_MAX_LOCAL_SIZE 4
+#define MIN_MAX_LEVELS_PER_DISPATCH 3
+
+#define MIN_MAX_MIPS_LEVEL_UNIFORM_LOC  1
+#define MIN_MAX_LEVEL_COUNT_UNIFORM_LOC 2
 #define SUM_PRESCALE_UNIFORM_LOC       1
+#define SUM_MODE_UNIFORM_LOC           2
+
+#define EXPORT_LOCAL_SIZE 64
+#define EXPORT_MAX_WORKGROUPS 65535
+
+#define EXPORT_PROCESSING_UNIFORM_LOC    1
+#define EXPORT_DYNAMIC_RANGE_UNIFORM_LOC 2
+#define EXPORT_REFERENCE_UNIFORM_LOC     3
+#define EXPORT_ROI_OFFSET_UNIFORM_LOC    4
+#define EXPORT_DECIMATION_UNIFORM_LOC    5
+#define EXPORT_OUTPUT_POINTS_UNIFORM_LOC 6
+#define EXPORT_WORD_COUNT_UNIFORM_LOC    7
 
 #define BEAMFORMER_CONSTANTS_LIST \
 	X(FilterSlots,                4) \
@@ -90,7 +144,7 @@ typedef enum {
 	X(MaxComputeShaderStages,    16) \
 	X(MaxParameterBlockSlots,    16) \
 	X(MaxRawDataFramesInFlight,   3) \
-	X(MaxSavedFrames,            16)
+	X(MaxSavedFrames,           256)
 #define X(k, v, ...) Beamformer##k = v,
 typedef enum {BEAMFORMER_CONSTANTS_LIST} BeamformerConstants;
 #undef X
@@ -105,6 +159,7 @@ typedef enum {BEAMFORMER_CONSTANTS_LIST} BeamformerConstants;
 	X(acquisition_count,      uint32_t,     , uint32,  1, "")                                        \
 	X(das_shader_id,          uint32_t,     , uint32,  1, "")                                        \
 	X(time_offset,            float,        , single,  1, "pulse length correction time [s]")        \
+	X(output_data_kind,       int32_t,      , int32,   1, "Float16[Complex]: half precision output") \
 	X(decode,                 uint8_t,      , uint8,   1, "Decode or just reshape data")             \
 	X(transmit_mode,          uint8_t,      , uint8,   1, "Method/Orientation of Transmit")          \
 	X(receive_mode,           uint8_t,      , uint8,   1, "Method/Orientation of Receive")           \
@@ -172,3 +227,50 @@ typedef struct {
 #define X(name, type, size, ...) type name size;
 typedef struct {BEAMFORMER_LIVE_IMAGING_PARAMETERS_LIST} BeamformerLiveImagingParameters;
 #undef X
+
+/* X(type, id, bytes per voxel (0: same as frame)) */
+#define BEAMFORMER_EXPORT_PROCESSING_LIST \
+	X(None,      0, 0) \
+	X(Magnitude, 1, 4) \
+	X(Decibel8,  2, 1) \
+	X(Decibel16, 3, 2)
+
+typedef enum {
+	#define X(type, id, ...) BeamformerExportProcessing_##type = id,
+	BEAMFORMER_EXPORT_PROCESSING_LIST
+	#undef X
+	BeamformerExportProcessing_Count
+} BeamformerExportProcessing;
+
+/* NOTE(rnp): applied on the GPU to beamformed data exports and the export stream.
+ * Magnitude exports float32. the Decibel kinds map [-dynamic_range, 0] dB relative to
+ * reference (1 if 0) onto the full range of a uint8_t/uint16_t. the region starts at
+ * roi_offset and covers roi_size voxels (0: rest of the frame) on each axis, keeping every
+ * decimation'th voxel (0 is treated as 1) */
+typedef struct {
+	uint32_t processing;
+	float    dynamic_range;
+	float    reference;
+	int32_t  roi_offset[3];
+	int32_t  roi_size[3];
+	int32_t  decimation[3];
+} BeamformerExportOptions;
+
+/* NOTE(rnp): describes a frame in the export stream. frame_number counts every frame
+ * written to the stream; frame_id is the beamformer's id for the frame. parameter_block_frame
+ * is the parameter block's completed frame count before this frame completed. data_kind is
+ * only meaningful when processing is None; otherwise processing determines the sample type.
+ * points and coordinates describe the exported region */
+typedef struct {
+	uint32_t frame_number;
+	uint32_t frame_id;
+	uint32_t parameter_block;
+	uint32_t parameter_block_frame;
+	uint32_t view_plane;
+	uint32_t data_kind;
+	uint32_t processing;
+	uint32_t size;
+	int32_t  points[3];
+	float    min_coordinate[3];
+	float    max_coordinate[3];
+} BeamformerExportFrameInfo;
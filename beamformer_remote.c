@@ -0,0 +1,80 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): wire protocol for clients which reach the beamformer over a socket instead of
+ * mapping its shared memory. every message is a header followed by payload_size bytes of
+ * payload. messages are handled in the order they were sent. only Hello and Export are
+ * answered; everything else is fire and forget so that RF frames can be streamed without a
+ * round trip each. the reply to the next answered message reports how many of those failed.
+ *
+ * arguments:
+ *   Hello:                  [version]                     reply: [version matches]
+ *   ReserveParameterBlocks: [count]
+ *   ParameterUpload:        [block, region, offset]       payload: bytes for the block
+ *   Pipeline:               [block, data_kind]            payload: i32 shader kinds
+ *   CreateFilter:           [kind, slot, block]           payload: BeamformerFilterParameters
+ *   ComputeIndirect:        [view plane, block]
+ *   RFData:                 [frame size, frame count, encoding, sample count]
+ *                           payload: frames (or one encoded frame)
+ *   LiveParameters:                                       payload: BeamformerLiveImagingParameters
+ *   ExportOptions:                                        payload: BeamformerExportOptions
+ *   Export:                 [kind, size, timeout ms]      reply: [success] payload: exported data
+ */
+
+#define BEAMFORMER_REMOTE_MESSAGE_KIND_LIST \
+	X(Hello)                  \
+	X(ReserveParameterBlocks) \
+	X(ParameterUpload)        \
+	X(Pipeline)               \
+	X(CreateFilter)           \
+	X(ComputeIndirect)        \
+	X(RFData)                 \
+	X(LiveParameters)         \
+	X(ExportOptions)          \
+	X(Export)
+
+typedef enum {
+	#define X(name) BeamformerRemoteMessageKind_##name,
+	BEAMFORMER_REMOTE_MESSAGE_KIND_LIST
+	#undef X
+	BeamformerRemoteMessageKind_Count,
+} BeamformerRemoteMessageKind;
+
+typedef struct {
+	u32 kind;
+	u32 arguments[4];
+	/* NOTE(rnp): replies only; fire and forget messages which failed since the last reply */
+	u32 failed;
+	u64 payload_size;
+} BeamformerRemoteHeader;
+static_assert(sizeof(BeamformerRemoteHeader) == 32, "remote header must have the same layout everywhere");
+
+/* NOTE(rnp): small payloads go out in the same packet as their header */
+function b32
+beamformer_remote_send(iptr handle, BeamformerRemoteHeader *header, void *payload)
+{
+	b32 result;
+	if (header->payload_size <= KB(4)) {
+		alignas(8) u8 buffer[sizeof(*header) + KB(4)];
+		mem_copy(buffer, header, sizeof(*header));
+		mem_copy(buffer + sizeof(*header), payload, (uz)header->payload_size);
+		result = os_socket_send(handle, buffer, sizeof(*header) + header->payload_size);
+	} else {
+		result = os_socket_send(handle, header, sizeof(*header)) &&
+		         os_socket_send(handle, payload, header->payload_size);
+	}
+	return result;
+}
+
+/* NOTE(rnp): reads and throws away size bytes of a payload which can't be used */
+function b32
+beamformer_remote_discard(iptr handle, u64 size)
+{
+	u8 buffer[KB(16)];
+	b32 result = 1;
+	while (result && size > 0) {
+		u64 chunk = MIN(size, sizeof(buffer));
+		result = os_socket_receive(handle, buffer, chunk);
+		size  -= chunk;
+	}
+	return result;
+}
@@ -1,5 +1,5 @@
 /* See LICENSE for license details. */
-#define BEAMFORMER_SHARED_MEMORY_VERSION (14UL)
+#define BEAMFORMER_SHARED_MEMORY_VERSION (29UL)
 
 typedef struct BeamformerFrame     BeamformerFrame;
 typedef struct ShaderReloadContext ShaderReloadContext;
@@ -13,8 +13,7 @@ typedef enum {
 	BeamformerWorkKind_UploadBuffer,
 } BeamformerWorkKind;
 
-/* TODO(rnp): this is massively bloating the queue; think of some other
- * way to communicate these to the beamformer */
+/* NOTE(rnp): too big for a work item; passed as a work queue payload */
 typedef struct {
 	union {
 		#define X(kind, ...) struct {__VA_ARGS__ ;} kind;
@@ -25,9 +24,9 @@ typedef struct {
 	b16 complex;
 } BeamformerFilterParameters;
 
+/* NOTE(rnp): parameters are stored in the work's payload */
 typedef struct {
-	BeamformerFilterKind       kind;
-	BeamformerFilterParameters parameters;
+	BeamformerFilterKind kind;
 	u8 filter_slot;
 	u8 parameter_block;
 	static_assert(BeamformerFilterSlots            <= 255, "CreateFilterContext only supports 255 filter slots");
@@ -44,6 +43,17 @@ typedef struct {
 	u32 size;
 } BeamformerExportContext;
 
+/* NOTE(rnp): export options clamped to a particular frame */
+typedef struct {
+	i32 offset[3];
+	i32 points[3];
+	i32 decimation[3];
+	u32 processing;
+	u32 voxel_size;
+	u64 size;
+	b32 full_frame;
+} BeamformerExportRegion;
+
 #define BEAMFORMER_SHARED_MEMORY_LOCKS \
 	X(ScratchSpace)    \
 	X(UploadRF)        \
@@ -54,9 +64,23 @@ typedef struct {
 typedef enum {BEAMFORMER_SHARED_MEMORY_LOCKS BeamformerSharedMemoryLockKind_Count} BeamformerSharedMemoryLockKind;
 #undef X
 
+typedef enum {
+	BeamformerComputeWorkFlags_RFUpload = 1 << 0,
+	BeamformerComputeWorkFlags_External = 1 << 1,
+	BeamformerComputeWorkFlags_Dropped  = 1 << 2,
+} BeamformerComputeWorkFlags;
+
 typedef struct {
-	BeamformerFrame *frame;
-	u32              parameter_block;
+	u32 frame_id;
+	u8  parameter_block;
+	u8  view_plane;
+
+	/* NOTE: filled in by the beamformer when the work is handed to a compute worker */
+	u8  rf_slot;
+	u8  flags;
+	u32 rf_sequence;
+	static_assert(BeamformerMaxParameterBlockSlots <= 255, "ComputeWorkContext only supports 255 parameter blocks");
+	static_assert(BeamformerViewPlaneTag_Count     <= 255, "ComputeWorkContext only supports 255 view planes");
 } BeamformerComputeWorkContext;
 
 typedef struct {
@@ -64,30 +88,68 @@ typedef struct {
 	u32                    parameter_block;
 } BeamformerComputeIndirectWorkContext;
 
-/* NOTE: discriminated union based on type */
+/* NOTE: discriminated union based on type. kept small so that a queue operation touches a
+ * single cache line; anything bigger goes in a payload (see below) */
 typedef struct {
-	BeamformerWorkKind kind;
-	BeamformerSharedMemoryLockKind lock;
+	u8 kind; /* BeamformerWorkKind */
+	u8 lock; /* BeamformerSharedMemoryLockKind */
+	/* NOTE(rnp): 1 + index of the payload owned by this work in its queue; 0 for none */
+	u8 payload;
 	union {
-		void                                 *generic;
 		BeamformerComputeWorkContext          compute_context;
 		BeamformerComputeIndirectWorkContext  compute_indirect_context;
 		BeamformerCreateFilterContext         create_filter_context;
 		BeamformerExportContext               export_context;
-		ShaderReloadContext                  *shader_reload_context;
 	};
 } BeamformWork;
+static_assert(sizeof(BeamformWork) == 16, "BeamformWork must stay 16 bytes");
 
+typedef union {
+	BeamformerFilterParameters  filter_parameters;
+	ShaderReloadContext        *shader_reload_context;
+} BeamformWorkPayload;
+
+/* NOTE(rnp): each entry's sequence tells a position in the ring whether it can use the
+ * entry. with lap = position & ~mask:
+ *   sequence == lap:     free for a producer at this position
+ *   sequence == lap + 1: holds committed work for the consumer
+ * popping advances the sequence to the next lap. zero initialized memory is an empty queue */
 typedef struct {
-	union {
-		u64 queue;
-		struct {u32 widx, ridx;};
-	};
-	BeamformWork work_items[1 << 6];
+	BeamformWork work;
+	u32          sequence;
+} BeamformWorkQueueEntry;
+
+#define BEAMFORM_WORK_QUEUE_PAYLOADS (32)
+
+/* NOTE(rnp): any number of producers (threads or processes) may push concurrently; only a
+ * single consumer may pop. payloads are claimed from a bitmask by the producer and handed
+ * back when the consumer commits the pop of the work that owns them */
+typedef struct {
+	u32 write_index;
+	u32 read_index;
+	u32 payloads_in_use;
+	BeamformWorkQueueEntry entries[1 << 7];
+	BeamformWorkPayload    payloads[BEAMFORM_WORK_QUEUE_PAYLOADS];
 } BeamformWorkQueue;
 
-#define BEAMFORMER_SHARED_MEMORY_SIZE             (GB(2))
-#define BEAMFORMER_SHARED_MEMORY_MAX_SCRATCH_SIZE (BEAMFORMER_SHARED_MEMORY_SIZE - \
+/* NOTE(rnp): RF slots live at the end of shared memory so that their position does not
+ * depend on the number of reserved parameter blocks */
+#define BEAMFORMER_RF_SLOT_COUNT                  (4)
+#define BEAMFORMER_RF_SLOT_SIZE                   (MB(128))
+#define BEAMFORMER_RF_SLOTS_SIZE                  (BEAMFORMER_RF_SLOT_COUNT * BEAMFORMER_RF_SLOT_SIZE)
+
+/* NOTE(rnp): export slots sit directly before the RF slots */
+#define BEAMFORMER_EXPORT_SLOT_COUNT              (4)
+#define BEAMFORMER_EXPORT_SLOT_SIZE               (MB(64))
+#define BEAMFORMER_EXPORT_SLOTS_SIZE              (BEAMFORMER_EXPORT_SLOT_COUNT * BEAMFORMER_EXPORT_SLOT_SIZE)
+
+/* NOTE(rnp): the region size is chosen when the beamformer starts and stored in the region.
+ * MAX_SCRATCH_SIZE is the scratch space available in the smallest allowed region */
+#define BEAMFORMER_SHARED_MEMORY_DEFAULT_SIZE     (GB(2))
+#define BEAMFORMER_SHARED_MEMORY_MIN_SIZE         (GB(1))
+#define BEAMFORMER_SHARED_MEMORY_MAX_SCRATCH_SIZE (BEAMFORMER_SHARED_MEMORY_MIN_SIZE - \
+                                                   BEAMFORMER_RF_SLOTS_SIZE - \
+                                                   BEAMFORMER_EXPORT_SLOTS_SIZE - \
                                                    sizeof(BeamformerSharedMemory) - \
                                                    sizeof(BeamformerParameterBlock))
 
@@ -111,6 +173,7 @@ typedef enum {
 
 typedef union {
 	u8 filter_slot;
+	u8 sum_mode;
 } BeamformerShaderParameters;
 
 typedef struct {
@@ -130,10 +193,6 @@ typedef struct {
 		};
 	};
 
-	/* NOTE(rnp): signals to the beamformer that a subregion of a block has been updated */
-	u32 dirty_regions;
-	static_assert(BeamformerParameterBlockRegion_Count <= 32, "only 32 parameter block regions supported");
-
 	BeamformerComputePipeline pipeline;
 
 	alignas(16) i16 channel_mapping[BeamformerMaxChannelCount];
@@ -150,8 +209,40 @@ read_only global u16 BeamformerParameterBlockRegionOffsets[BeamformerParameterBl
 };
 #undef X
 
+#define X(k, field) [BeamformerParameterBlockRegion_##k] = sizeof(((BeamformerParameterBlock *)0)->field),
+read_only global u16 BeamformerParameterBlockRegionSizes[BeamformerParameterBlockRegion_Count] = {
+	BEAMFORMER_PARAMETER_BLOCK_REGION_LIST
+};
+#undef X
+
+typedef enum {
+	BeamformerRFSlotState_Free,
+	BeamformerRFSlotState_Filling,
+	BeamformerRFSlotState_Ready,
+} BeamformerRFSlotState;
+
+/* NOTE(rnp): clients acquire slots in order, write their data directly into the slot's
+ * memory and mark it ready. the upload thread moves ready slots to the GPU in the same
+ * order and then frees them. waiters can sleep on state since freeing stores 0 */
+typedef struct {
+	i32 state;
+	u32 frame_size;
+	u32 frame_count;
+	/* NOTE(rnp): encoded slots hold a single frame; frame_size is its decoded size */
+	BeamformerRFEncoding encoding;
+	u32                  encoded_size;
+} BeamformerRFSlot;
+
+/* NOTE(rnp): sequence is a seqlock; it is odd while the beamformer writes the slot. readers
+ * copy the slot and retry if the sequence changed underneath them. waiters can sleep on it */
+typedef struct {
+	i32                       sequence;
+	BeamformerExportFrameInfo info;
+} BeamformerExportSlot;
+
 typedef struct {
 	u32 version;
+	u64 size;
 
 	/* NOTE(rnp): causes future library calls to fail.
 	 * see note in beamformer_invalidate_shared_memory() */
@@ -168,63 +259,171 @@ typedef struct {
 
 	/* TODO(rnp): this is really sucky. we need a better way to communicate this */
 	u32 scratch_rf_size;
+	/* NOTE(rnp): number of scratch_rf_size frames packed back to back in scratch space */
+	u32 scratch_rf_frame_count;
+	/* NOTE(rnp): when encoded scratch_rf_size is the decoded size of the single frame */
+	BeamformerRFEncoding scratch_rf_encoding;
+	u32                  scratch_rf_encoded_size;
+
+	BeamformerRFSlot rf_slots[BEAMFORMER_RF_SLOT_COUNT];
+	u32              rf_slot_write_index;
+	u32              rf_slot_read_index;
 
 	BeamformerLiveImagingParameters live_imaging_parameters;
 	BeamformerLiveImagingDirtyFlags live_imaging_dirty_flags;
 
+	/* NOTE(rnp): number of frames each parameter block has finished beamforming. only ever
+	 * increases (modulo wrap around). frames which were dropped are counted so that clients
+	 * waiting on a count don't stall. clients can sleep on these since they are never reset */
+	i32 completed_frames[BeamformerMaxParameterBlockSlots];
+
+	/* NOTE(rnp): parameter blocks are double buffered. writers fill the staging copy (after
+	 * the scratch header, see beamformer_parameter_block()) under the block lock and then
+	 * publish the regions they touched into published_parameter_blocks. the published copy
+	 * is only ever written inside an odd parameter_block_sequences value so the beamformer
+	 * can take a consistent snapshot without a lock and writers never wait on compute.
+	 * parameter_block_dirty_regions tells the beamformer which regions were published */
+	i32                      parameter_block_sequences[BeamformerMaxParameterBlockSlots];
+	u32                      parameter_block_dirty_regions[BeamformerMaxParameterBlockSlots];
+	static_assert(BeamformerParameterBlockRegion_Count <= 32, "only 32 parameter block regions supported");
+	BeamformerParameterBlock published_parameter_blocks[BeamformerMaxParameterBlockSlots];
+
+	/* NOTE(rnp): when enabled every completed frame is also written into the export ring.
+	 * export_stream_write_index is the frame number the next frame will get */
+	b32                  export_stream_enabled;
+	u32                  export_stream_write_index;
+	BeamformerExportSlot export_slots[BEAMFORMER_EXPORT_SLOT_COUNT];
+
+	/* NOTE(rnp): applies to both beamformed data exports and the export stream */
+	BeamformerExportOptions export_options;
+	/* NOTE(rnp): export_options as they were when the pending beamformed data export was
+	 * requested. written by the requester while it holds ExportSync */
+	BeamformerExportOptions export_buffer_options;
+
 	BeamformWorkQueue external_work_queue;
 } BeamformerSharedMemory;
 
 function BeamformWork *
 beamform_work_queue_pop(BeamformWorkQueue *q)
 {
-	BeamformWork *result = 0;
-
-	static_assert(ISPOWEROF2(countof(q->work_items)), "queue capacity must be a power of 2");
-	u64 val  = atomic_load_u64(&q->queue);
-	u64 mask = countof(q->work_items) - 1;
-	u64 widx = val       & mask;
-	u64 ridx = val >> 32 & mask;
+	static_assert(ISPOWEROF2(countof(q->entries)), "queue capacity must be a power of 2");
+	u32 mask  = countof(q->entries) - 1;
+	u32 index = atomic_load_u32(&q->read_index);
 
-	if (ridx != widx)
-		result = q->work_items + ridx;
+	BeamformWorkQueueEntry *e = q->entries + (index & mask);
+	BeamformWork *result = 0;
+	if (atomic_load_u32(&e->sequence) == (index & ~mask) + 1)
+		result = &e->work;
+	return result;
+}
 
+function BeamformWorkPayload *
+beamform_work_queue_payload(BeamformWorkQueue *q, BeamformWork *work)
+{
+	BeamformWorkPayload *result = 0;
+	if (work->payload) result = q->payloads + (work->payload - 1) % BEAMFORM_WORK_QUEUE_PAYLOADS;
 	return result;
 }
 
 function void
 beamform_work_queue_pop_commit(BeamformWorkQueue *q)
 {
-	atomic_add_u64(&q->queue, 0x100000000ULL);
+	u32 mask  = countof(q->entries) - 1;
+	u32 index = q->read_index;
+	BeamformWorkQueueEntry *e = q->entries + (index & mask);
+	if (e->work.payload)
+		atomic_and_u32(&q->payloads_in_use, ~(1u << ((e->work.payload - 1) % BEAMFORM_WORK_QUEUE_PAYLOADS)));
+	atomic_store_u32(&e->sequence, (index & ~mask) + countof(q->entries));
+	atomic_store_u32(&q->read_index, index + 1);
 }
 
+/* NOTE(rnp): the returned work must always be committed; an uncommitted entry stalls the
+ * consumer. returns 0 when the queue is full */
 function BeamformWork *
 beamform_work_queue_push(BeamformWorkQueue *q)
 {
+	static_assert(ISPOWEROF2(countof(q->entries)), "queue capacity must be a power of 2");
+	u32 mask = countof(q->entries) - 1;
+
 	BeamformWork *result = 0;
+	u32 index = atomic_load_u32(&q->write_index);
+	for (;;) {
+		BeamformWorkQueueEntry *e = q->entries + (index & mask);
+		i32 delta = (i32)(atomic_load_u32(&e->sequence) - (index & ~mask));
+		if (delta == 0) {
+			/* NOTE(rnp): on failure index is reloaded with the current write index */
+			if (atomic_cas_u32(&q->write_index, &index, index + 1)) {
+				result = &e->work;
+				zero_struct(result);
+				break;
+			}
+		} else if (delta < 0) {
+			/* NOTE(rnp): the consumer hasn't made it around the ring yet */
+			break;
+		} else {
+			/* NOTE(rnp): another producer claimed this position */
+			index = atomic_load_u32(&q->write_index);
+		}
+	}
 
-	static_assert(ISPOWEROF2(countof(q->work_items)), "queue capacity must be a power of 2");
-	u64 val  = atomic_load_u64(&q->queue);
-	u64 mask = countof(q->work_items) - 1;
-	u64 widx = val        & mask;
-	u64 ridx = val >> 32  & mask;
-	u64 next = (widx + 1) & mask;
+	return result;
+}
 
-	if (val & 0x80000000)
-		atomic_and_u64(&q->queue, ~0x80000000);
+function void
+beamform_work_queue_push_commit(BeamformWorkQueue *q, BeamformWork *work)
+{
+	BeamformWorkQueueEntry *e = (BeamformWorkQueueEntry *)work;
+	assert(e >= q->entries && e < q->entries + countof(q->entries));
+	atomic_store_u32(&e->sequence, e->sequence + 1);
+}
 
-	if (next != ridx) {
-		result = q->work_items + widx;
-		zero_struct(result);
+/* NOTE(rnp): like beamform_work_queue_push() but also claims a zeroed payload. returns 0
+ * if either the queue or the payloads are full */
+function BeamformWork *
+beamform_work_queue_push_with_payload(BeamformWorkQueue *q, BeamformWorkPayload **payload)
+{
+	static_assert(BEAMFORM_WORK_QUEUE_PAYLOADS == 32, "payloads are tracked with a u32 bitmask");
+	BeamformWork *result = 0;
+	u32 in_use = atomic_load_u32(&q->payloads_in_use);
+	u32 index  = 0;
+	b32 found  = 0;
+	while (!found && in_use != U32_MAX) {
+		index = ctz_u32(~in_use);
+		found = atomic_cas_u32(&q->payloads_in_use, &in_use, in_use | (1u << index));
 	}
 
+	if (found) {
+		result = beamform_work_queue_push(q);
+		if (result) {
+			result->payload = (u8)(index + 1);
+			*payload = q->payloads + index;
+			zero_struct(*payload);
+		} else {
+			atomic_and_u32(&q->payloads_in_use, ~(1u << index));
+		}
+	}
 	return result;
 }
 
-function void
-beamform_work_queue_push_commit(BeamformWorkQueue *q)
+/* NOTE(rnp): copies work (and its payload) from one queue into another */
+function b32
+beamform_work_queue_push_copy(BeamformWorkQueue *q, BeamformWorkQueue *from, BeamformWork *work)
 {
-	atomic_add_u64(&q->queue, 1);
+	BeamformWorkPayload *from_payload = beamform_work_queue_payload(from, work);
+	BeamformWorkPayload *payload      = 0;
+
+	BeamformWork *result;
+	if (from_payload) result = beamform_work_queue_push_with_payload(q, &payload);
+	else              result = beamform_work_queue_push(q);
+
+	if (result) {
+		u8 index = result->payload;
+		*result  = *work;
+		result->payload = index;
+		if (payload) *payload = *from_payload;
+		beamform_work_queue_push_commit(q, result);
+	}
+	return result != 0;
 }
 
 function BeamformerParameterBlock *
@@ -238,10 +437,28 @@ beamformer_parameter_block(BeamformerSharedMemory *sm, u32 block)
 function b32
 beamformer_parameter_block_dirty(BeamformerSharedMemory *sm, u32 block)
 {
-	b32 result = beamformer_parameter_block(sm, block)->dirty_regions != 0;
+	b32 result = atomic_load_u32(sm->parameter_block_dirty_regions + block) != 0;
 	return result;
 }
 
+/* NOTE(rnp): copies the published block into out. never blocks; a publish is a short copy
+ * so if one is in progress (odd sequence) or lands during the copy the copy is retried */
+function void
+beamformer_parameter_block_snapshot(BeamformerSharedMemory *sm, u32 block, BeamformerParameterBlock *out)
+{
+	assert(block < BeamformerMaxParameterBlockSlots);
+	i32 *sequence = sm->parameter_block_sequences + block;
+	for (;;) {
+		i32 start = atomic_load_u32(sequence);
+		if ((start & 1) == 0) {
+			mem_copy(out, sm->published_parameter_blocks + block, sizeof(*out));
+			memory_read_barrier();
+			if (atomic_load_u32(sequence) == start)
+				break;
+		}
+	}
+}
+
 function BeamformerParameterBlock *
 beamformer_parameter_block_lock(SharedMemoryRegion *sm, u32 block, i32 timeout_ms)
 {
@@ -266,23 +483,173 @@ beamformer_shared_memory_scratch_arena(BeamformerSharedMemory *sm)
 {
 	assert(sm->reserved_parameter_blocks > 0);
 	BeamformerParameterBlock *last = beamformer_parameter_block(sm, sm->reserved_parameter_blocks);
-	Arena result = {.beg = (u8 *)(last + 1), .end = (u8 *)sm + BEAMFORMER_SHARED_MEMORY_SIZE};
+	Arena result = {.beg = (u8 *)(last + 1)};
+	result.end = (u8 *)sm + sm->size - BEAMFORMER_RF_SLOTS_SIZE - BEAMFORMER_EXPORT_SLOTS_SIZE;
 	result.beg = arena_aligned_start(result, KB(4));
 	return result;
 }
 
+function u8 *
+beamformer_rf_slot_data(BeamformerSharedMemory *sm, u32 slot)
+{
+	assert(slot < BEAMFORMER_RF_SLOT_COUNT);
+	u8 *result = (u8 *)sm + sm->size - BEAMFORMER_RF_SLOTS_SIZE;
+	result += (uz)slot * BEAMFORMER_RF_SLOT_SIZE;
+	return result;
+}
+
+/* NOTE(rnp): claims the next slot in order if it is free. a stale index could point at a
+ * slot that was freed after another client already claimed it; it is given back and the
+ * claim is retried. returns -1 if the next slot is still in use */
+function i32
+beamformer_rf_slot_try_acquire(BeamformerSharedMemory *sm, u32 frame_size, u32 frame_count)
+{
+	i32 result = -1;
+	for (;;) {
+		u32 index = atomic_load_u32(&sm->rf_slot_write_index);
+		BeamformerRFSlot *slot = sm->rf_slots + index % BEAMFORMER_RF_SLOT_COUNT;
+
+		i32 state = BeamformerRFSlotState_Free;
+		if (!atomic_cas_u32(&slot->state, &state, BeamformerRFSlotState_Filling))
+			break;
+
+		if (atomic_cas_u32(&sm->rf_slot_write_index, &index, index + 1)) {
+			slot->frame_size  = frame_size;
+			slot->frame_count = frame_count;
+			slot->encoding    = BeamformerRFEncoding_None;
+			result = (i32)(index % BEAMFORMER_RF_SLOT_COUNT);
+			break;
+		}
+		atomic_store_u32(&slot->state, BeamformerRFSlotState_Free);
+	}
+	return result;
+}
+
+/* NOTE(rnp): w32 can't wake a waiter in another process so callers only wait in short steps */
+function void
+beamformer_rf_slot_wait(BeamformerSharedMemory *sm, u32 timeout_ms)
+{
+	BeamformerRFSlot *slot = sm->rf_slots + atomic_load_u32(&sm->rf_slot_write_index) % BEAMFORMER_RF_SLOT_COUNT;
+	i32 state = atomic_load_u32(&slot->state);
+	if (state != BeamformerRFSlotState_Free)
+		os_wait_on_value(&slot->state, state, timeout_ms);
+}
+
+function u8 *
+beamformer_export_slot_data(BeamformerSharedMemory *sm, u32 slot)
+{
+	assert(slot < BEAMFORMER_EXPORT_SLOT_COUNT);
+	u8 *result = (u8 *)sm + sm->size - BEAMFORMER_RF_SLOTS_SIZE - BEAMFORMER_EXPORT_SLOTS_SIZE;
+	result += (uz)slot * BEAMFORMER_EXPORT_SLOT_SIZE;
+	return result;
+}
+
+function BeamformerExportRegion
+beamformer_export_region(BeamformerExportOptions *options, i32 dim[3], u32 frame_voxel_size)
+{
+	#define X(type, id, bytes) bytes,
+	read_only local_persist u32 voxel_sizes[] = {BEAMFORMER_EXPORT_PROCESSING_LIST};
+	#undef X
+
+	BeamformerExportRegion result = {0};
+	result.processing = options->processing < BeamformerExportProcessing_Count ? options->processing : 0;
+	result.voxel_size = voxel_sizes[result.processing];
+	if (result.voxel_size == 0) result.voxel_size = frame_voxel_size;
+
+	result.full_frame = 1;
+	u64 voxels = 1;
+	for (u32 i = 0; i < 3; i++) {
+		i32 size = MAX(1, dim[i]);
+		result.decimation[i] = MAX(1, options->decimation[i]);
+		result.offset[i]     = CLAMP(options->roi_offset[i], 0, size - 1);
+		size -= result.offset[i];
+		if (options->roi_size[i] > 0) size = MIN(size, options->roi_size[i]);
+		result.points[i]     = (size + result.decimation[i] - 1) / result.decimation[i];
+		result.full_frame   &= result.points[i] == MAX(1, dim[i]);
+		voxels *= (u64)result.points[i];
+	}
+	result.size = voxels * result.voxel_size;
+	return result;
+}
+
+typedef enum {
+	BeamformerPipelineCheck_Valid,
+	BeamformerPipelineCheck_StageOverflow,
+	BeamformerPipelineCheck_InvalidStage,
+	BeamformerPipelineCheck_InvalidStartShader,
+	BeamformerPipelineCheck_InvalidDemodDataKind,
+} BeamformerPipelineCheck;
+
+/* NOTE(rnp): shared by the library and the remote server so both accept the same pipelines */
+function BeamformerPipelineCheck
+beamformer_check_pipeline(i32 *shaders, u32 shader_count, BeamformerDataKind data_kind)
+{
+	BeamformerPipelineCheck result = BeamformerPipelineCheck_Valid;
+	if (shader_count > BeamformerMaxComputeShaderStages) {
+		result = BeamformerPipelineCheck_StageOverflow;
+	} else {
+		for (u32 i = 0; result == BeamformerPipelineCheck_Valid && i < shader_count; i++) {
+			if (!BETWEEN(shaders[i], BeamformerShaderKind_ComputeFirst, BeamformerShaderKind_ComputeLast) ||
+			    shaders[i] == BeamformerShaderKind_Export)
+			{
+				result = BeamformerPipelineCheck_InvalidStage;
+			}
+		}
+
+		if (result == BeamformerPipelineCheck_Valid &&
+		    shaders[0] != BeamformerShaderKind_Demodulate && shaders[0] != BeamformerShaderKind_Decode)
+		{
+			result = BeamformerPipelineCheck_InvalidStartShader;
+		}
+
+		if (result == BeamformerPipelineCheck_Valid && shaders[0] == BeamformerShaderKind_Demodulate &&
+		    !(data_kind == BeamformerDataKind_Int16 || data_kind == BeamformerDataKind_Float32))
+		{
+			result = BeamformerPipelineCheck_InvalidDemodDataKind;
+		}
+	}
+	return result;
+}
+
+/* NOTE(rnp): must be called with the block lock held (it serializes writers). copies the
+ * region from the staging block into the published block and marks it dirty */
 function void
-mark_parameter_block_region_dirty(BeamformerSharedMemory *sm, u32 block, BeamformerParameterBlockRegions region)
+publish_parameter_block_region(BeamformerSharedMemory *sm, u32 block, BeamformerParameterBlockRegions region)
 {
-	BeamformerParameterBlock *pb = beamformer_parameter_block(sm, block);
-	atomic_or_u32(&pb->dirty_regions, 1 << region);
+	assert(block < BeamformerMaxParameterBlockSlots && region < BeamformerParameterBlockRegion_Count);
+	u16 offset = BeamformerParameterBlockRegionOffsets[region];
+	i32 *sequence = sm->parameter_block_sequences + block;
+
+	atomic_add_u32(sequence, 1);
+	mem_copy((u8 *)(sm->published_parameter_blocks + block) + offset,
+	         (u8 *)beamformer_parameter_block(sm, block) + offset,
+	         BeamformerParameterBlockRegionSizes[region]);
+	atomic_add_u32(sequence, 1);
+
+	atomic_or_u32(sm->parameter_block_dirty_regions + block, 1u << region);
 }
 
+/* NOTE(rnp): clears both copies of a newly reserved block */
 function void
-mark_parameter_block_region_clean(BeamformerSharedMemory *sm, u32 block, BeamformerParameterBlockRegions region)
+reset_parameter_block(BeamformerSharedMemory *sm, u32 block)
 {
-	BeamformerParameterBlock *pb = beamformer_parameter_block(sm, block);
-	atomic_and_u32(&pb->dirty_regions, ~(1 << region));
+	assert(block < BeamformerMaxParameterBlockSlots);
+	BeamformerParameterBlock *published = sm->published_parameter_blocks + block;
+	i32 *sequence = sm->parameter_block_sequences + block;
+	atomic_add_u32(sequence, 1);
+	zero_struct(published);
+	atomic_add_u32(sequence, 1);
+	zero_struct(beamformer_parameter_block(sm, block));
+	atomic_store_u32(sm->parameter_block_dirty_regions + block, 0);
+}
+
+/* NOTE(rnp): clears and returns the regions published since the last call. a region
+ * published after this call is marked dirty again so it can't be missed by a snapshot */
+function u32
+take_parameter_block_dirty_regions(BeamformerSharedMemory *sm, u32 block)
+{
+	u32 result = atomic_swap_u32(sm->parameter_block_dirty_regions + block, 0);
+	return result;
 }
 
 function void
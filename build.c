@@ -63,7 +63,7 @@ global char *g_argv0;
 
   #include "os_linux.c"
 
-  #define W32_DECL(x)
+  #define W32_DECL(...)
 
   #define OS_SHARED_LINK_LIB(s) "lib" s ".so"
   #define OS_SHARED_LIB(s)      s ".so"
@@ -74,7 +74,7 @@ global char *g_argv0;
 
   #include "os_win32.c"
 
-  #define W32_DECL(x) x
+  #define W32_DECL(...) __VA_ARGS__
 
   #define OS_SHARED_LINK_LIB(s) s ".dll"
   #define OS_SHARED_LIB(s)      s ".dll"
@@ -473,15 +473,6 @@ check_rebuild_self(Arena arena, i32 argc, char *argv[])
 	}
 }
 
-function b32
-s8_equal(s8 a, s8 b)
-{
-	b32 result = a.len == b.len;
-	for (iz i = 0; result && i < a.len; i++)
-		result = a.data[i] == b.data[i];
-	return result;
-}
-
 function void
 usage(char *argv0)
 {
@@ -652,7 +643,7 @@ build_helper_library(Arena arena, CommandList cc)
 	/////////////
 	// library
 	char *library = OUTPUT(OS_SHARED_LIB("ogl_beamformer_lib"));
-	char *libs[]  = {LINK_LIB("Synchronization")};
+	char *libs[]  = {LINK_LIB("Synchronization"), LINK_LIB("ws2_32")};
 	iz libs_count = is_w32 ? countof(libs) : 0;
 
 	if (!is_msvc) cmd_append(&arena, &cc, "-Wno-unused-function");
@@ -680,7 +671,8 @@ function b32
 build_tests(Arena arena, CommandList cc)
 {
 	#define TEST_PROGRAMS \
-		X("throughput", LINK_LIB("zstd"), W32_DECL(LINK_LIB("Synchronization")))
+		X("throughput",      LINK_LIB("zstd"), W32_DECL(LINK_LIB("Synchronization"), LINK_LIB("ws2_32"))) \
+		X("remote_loopback", W32_DECL(LINK_LIB("Synchronization"), LINK_LIB("ws2_32")))
 
 	os_make_directory(OUTPUT("tests"));
 	if (!is_msvc) cmd_append(&arena, &cc, "-Wno-unused-function");
@@ -2497,7 +2489,7 @@ main(i32 argc, char *argv[])
 	if (is_unix)  cmd_append(&arena, &c, "-lGL");
 	if (is_w32) {
 		cmd_append(&arena, &c, LINK_LIB("user32"), LINK_LIB("shell32"), LINK_LIB("gdi32"),
-		           LINK_LIB("opengl32"), LINK_LIB("winmm"), LINK_LIB("Synchronization"));
+		           LINK_LIB("opengl32"), LINK_LIB("winmm"), LINK_LIB("Synchronization"), LINK_LIB("ws2_32"));
 		if (!is_msvc) cmd_append(&arena, &c, "-Wl,--out-implib," OUTPUT(OS_STATIC_LIB("main")));
 	}
 	cmd_append(&arena, &c, (void *)0);
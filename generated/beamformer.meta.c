@@ -7,6 +7,8 @@ typedef enum {
 	BeamformerDataKind_Int16Complex   = 1,
 	BeamformerDataKind_Float32        = 2,
 	BeamformerDataKind_Float32Complex = 3,
+	BeamformerDataKind_Float16        = 4,
+	BeamformerDataKind_Float16Complex = 5,
 	BeamformerDataKind_Count,
 } BeamformerDataKind;
 
@@ -56,12 +58,13 @@ typedef enum {
 	BeamformerShaderKind_DAS         = 5,
 	BeamformerShaderKind_MinMax      = 6,
 	BeamformerShaderKind_Sum         = 7,
-	BeamformerShaderKind_Render3D    = 8,
+	BeamformerShaderKind_Export      = 8,
+	BeamformerShaderKind_Render3D    = 9,
 	BeamformerShaderKind_Count,
 
 	BeamformerShaderKind_ComputeFirst = BeamformerShaderKind_CudaDecode,
-	BeamformerShaderKind_ComputeLast  = BeamformerShaderKind_Sum,
-	BeamformerShaderKind_ComputeCount = 8,
+	BeamformerShaderKind_ComputeLast  = BeamformerShaderKind_Export,
+	BeamformerShaderKind_ComputeCount = 9,
 	BeamformerShaderKind_RenderFirst  = BeamformerShaderKind_Render3D,
 	BeamformerShaderKind_RenderLast   = BeamformerShaderKind_Render3D,
 	BeamformerShaderKind_RenderCount  = 1,
@@ -147,14 +150,41 @@ read_only global i32 *beamformer_shader_match_vectors[] = {
 	(i32 []){BeamformerDataKind_Float32Complex, 0x05},
 	(i32 []){BeamformerDataKind_Float32Complex, 0x06},
 	(i32 []){BeamformerDataKind_Float32Complex, 0x07},
+	(i32 []){BeamformerDataKind_Float16, 0x00},
+	(i32 []){BeamformerDataKind_Float16, 0x01},
+	(i32 []){BeamformerDataKind_Float16, 0x02},
+	(i32 []){BeamformerDataKind_Float16, 0x03},
+	(i32 []){BeamformerDataKind_Float16, 0x04},
+	(i32 []){BeamformerDataKind_Float16, 0x05},
+	(i32 []){BeamformerDataKind_Float16, 0x06},
+	(i32 []){BeamformerDataKind_Float16, 0x07},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x00},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x01},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x02},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x03},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x04},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x05},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x06},
+	(i32 []){BeamformerDataKind_Float16Complex, 0x07},
 	// MinMax
-	0,
+	(i32 []){BeamformerDataKind_Float32},
+	(i32 []){BeamformerDataKind_Float32Complex},
+	(i32 []){BeamformerDataKind_Float16},
+	(i32 []){BeamformerDataKind_Float16Complex},
 	// Sum
-	0,
+	(i32 []){BeamformerDataKind_Float32},
+	(i32 []){BeamformerDataKind_Float32Complex},
+	(i32 []){BeamformerDataKind_Float16},
+	(i32 []){BeamformerDataKind_Float16Complex},
+	// Export
+	(i32 []){BeamformerDataKind_Float32},
+	(i32 []){BeamformerDataKind_Float32Complex},
+	(i32 []){BeamformerDataKind_Float16},
+	(i32 []){BeamformerDataKind_Float16Complex},
 	// Render3D
 	0,
 };
-#define beamformer_match_vectors_count (62)
+#define beamformer_match_vectors_count (88)
 
 read_only global BeamformerShaderDescriptor beamformer_shader_descriptors[] = {
 	{0,  1,  0, 0, 0},
@@ -162,10 +192,11 @@ read_only global BeamformerShaderDescriptor beamformer_shader_descriptors[] = {
 	{2,  7,  1, 2, 1},
 	{7,  19, 1, 1, 1},
 	{19, 43, 2, 2, 1},
-	{43, 59, 1, 2, 1},
-	{59, 60, 0, 0, 0},
-	{60, 61, 0, 0, 0},
-	{61, 62, 0, 0, 0},
+	{43, 75, 1, 2, 1},
+	{75, 79, 1, 1, 0},
+	{79, 83, 1, 1, 0},
+	{83, 87, 1, 1, 0},
+	{87, 88, 0, 0, 0},
 };
 
 read_only global s8 beamformer_shader_names[] = {
@@ -177,6 +208,7 @@ read_only global s8 beamformer_shader_names[] = {
 	s8_comp("DAS"),
 	s8_comp("MinMax"),
 	s8_comp("Sum"),
+	s8_comp("Export"),
 	s8_comp("Render3D"),
 };
 
@@ -186,6 +218,7 @@ read_only global BeamformerReloadableShaderInfo beamformer_reloadable_shader_inf
 	{BeamformerShaderKind_DAS,      0, 0},
 	{BeamformerShaderKind_MinMax,   0, 0},
 	{BeamformerShaderKind_Sum,      0, 0},
+	{BeamformerShaderKind_Export,   0, 0},
 	{BeamformerShaderKind_Render3D, 0, 0},
 };
 
@@ -195,6 +228,7 @@ read_only global s8 beamformer_reloadable_shader_files[] = {
 	s8_comp("das.glsl"),
 	s8_comp("min_max.glsl"),
 	s8_comp("sum.glsl"),
+	s8_comp("export.glsl"),
 	s8_comp("render_3d.frag.glsl"),
 };
 
@@ -204,10 +238,11 @@ read_only global i32 beamformer_reloadable_compute_shader_info_indices[] = {
 	2,
 	3,
 	4,
+	5,
 };
 
 read_only global i32 beamformer_reloadable_render_shader_info_indices[] = {
-	5,
+	6,
 };
 
 read_only global s8 beamformer_shader_global_header_strings[] = {
@@ -216,6 +251,8 @@ read_only global s8 beamformer_shader_global_header_strings[] = {
 	"#define DataKind_Int16Complex   1\n"
 	"#define DataKind_Float32        2\n"
 	"#define DataKind_Float32Complex 3\n"
+	"#define DataKind_Float16        4\n"
+	"#define DataKind_Float16Complex 5\n"
 	"\n"),
 	s8_comp(""
 	"#define DecodeMode_None     0\n"
@@ -251,6 +288,7 @@ read_only global s8 beamformer_shader_local_header_strings[] = {
 	{0},
 	{0},
 	{0},
+	{0},
 };
 
 read_only global s8 beamformer_shader_descriptor_header_strings[] = {
@@ -267,8 +305,9 @@ read_only global i32 *beamformer_shader_header_vectors[] = {
 	(i32 []){0},
 	(i32 []){0, 3},
 	(i32 []){0, 2},
-	0,
-	0,
+	(i32 []){0},
+	(i32 []){0},
+	(i32 []){0},
 	0,
 };
 
@@ -318,7 +357,28 @@ beamformer_shader_demodulate_match(BeamformerDataKind a, BeamformerSamplingMode
 function iz
 beamformer_shader_das_match(BeamformerDataKind a, i32 flags)
 {
-	iz result = beamformer_shader_match((i32 []){(i32)a, flags}, 43, 59, 2);
+	iz result = beamformer_shader_match((i32 []){(i32)a, flags}, 43, 75, 2);
+	return result;
+}
+
+function iz
+beamformer_shader_minmax_match(BeamformerDataKind a)
+{
+	iz result = beamformer_shader_match((i32 []){(i32)a}, 75, 79, 1);
+	return result;
+}
+
+function iz
+beamformer_shader_sum_match(BeamformerDataKind a)
+{
+	iz result = beamformer_shader_match((i32 []){(i32)a}, 79, 83, 1);
+	return result;
+}
+
+function iz
+beamformer_shader_export_match(BeamformerDataKind a)
+{
+	iz result = beamformer_shader_match((i32 []){(i32)a}, 83, 87, 1);
 	return result;
 }
 
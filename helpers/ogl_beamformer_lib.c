@@ -17,13 +17,47 @@ W32(iptr) OpenFileMappingA(u32, b32, c8 *);
 #error Unsupported Platform
 #endif
 
+#include "../memory_copy.c"
+#include "../rf_encoding.c"
 #include "../beamformer_shared_memory.c"
+#include "../beamformer_remote.c"
+
+/* NOTE(rnp): a frame submitted with beamformer_beamform_submit(). frame is the parameter
+ * block's completed frame count before the frame completes */
+typedef struct {
+	u32 ticket;
+	u32 parameter_block;
+	u32 frame;
+	b32 pending;
+} BeamformerTicket;
 
 global struct {
 	SharedMemoryRegion      shared_memory;
 	BeamformerSharedMemory *bp;
 	i32                     timeout_ms;
 	BeamformerLibErrorKind  last_error;
+
+	/* NOTE(rnp): helper threads are only started the first time a copy is large enough */
+	MemoryCopyEngine        copy_engine;
+	u32                     copy_threshold;
+	b32                     copy_engine_started;
+
+	/* NOTE(rnp): while connected calls are forwarded over the socket instead of going
+	 * through shared memory. the export options are kept to size exports locally */
+	iptr                    remote_socket;
+	b32                     remote;
+	BeamformerExportOptions remote_export_options;
+
+	/* NOTE(rnp): tickets are handed out in order and a ticket's entry is reused as many
+	 * tickets later as there are export stream slots. the ticket in that entry must have
+	 * been retrieved by then since its frame may be overwritten by the newer ones */
+	BeamformerTicket        tickets[BEAMFORMER_EXPORT_SLOT_COUNT];
+	u32                     ticket_write_index;
+	u32                     ticket_next_frame[BeamformerMaxParameterBlockSlots];
+	/* NOTE(rnp): tickets need the export stream; it is forced on while any are pending and
+	 * put back to the state requested with beamformer_set_export_stream() afterwards */
+	u32                     tickets_pending;
+	b32                     export_stream_requested;
 } g_beamformer_library_context;
 
 #if OS_LINUX
@@ -40,11 +74,14 @@ os_open_shared_memory_area(char *name)
 {
 	SharedMemoryRegion result = {0};
 	i32 fd = shm_open(name, O_RDWR, S_IRUSR|S_IWUSR);
-	if (fd > 0) {
-		void *new = mmap(0, BEAMFORMER_SHARED_MEMORY_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	/* NOTE(rnp): the beamformer may have been started with huge pages */
+	if (fd < 0) fd = open(OS_HUGE_PAGES_PATH OS_SHARED_MEMORY_NAME, O_RDWR);
+	struct stat st;
+	if (fd >= 0 && fstat(fd, &st) == 0) {
+		void *new = mmap(0, (uz)st.st_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
 		if (new != MAP_FAILED) result.region = new;
-		close(fd);
 	}
+	if (fd >= 0) close(fd);
 	return result;
 }
 
@@ -99,7 +136,8 @@ os_open_shared_memory_area(char *name)
 	SharedMemoryRegion result = {0};
 	iptr h = OpenFileMappingA(FILE_MAP_ALL_ACCESS, 0, name);
 	if (h != INVALID_FILE) {
-		void *new = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, BEAMFORMER_SHARED_MEMORY_SIZE);
+		/* NOTE(rnp): 0 maps the whole region regardless of the size it was created with */
+		void *new = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, 0);
 		if (new && os_reserve_region_locks((iptr)&ctx, 1)) {
 			result.region     = new;
 			result.os_context = (iptr)&ctx;
@@ -173,6 +211,85 @@ lib_release_lock(i32 lock)
 	                               g_beamformer_library_context.bp->locks, (i32)lock);
 }
 
+function void
+lib_memory_copy(void *restrict dest, void *restrict src, uz size)
+{
+	MemoryCopyEngine *e = &g_beamformer_library_context.copy_engine;
+	u64 threshold = g_beamformer_library_context.copy_threshold;
+	if (threshold == 0) threshold = MEMORY_COPY_DEFAULT_THRESHOLD;
+
+	if (!g_beamformer_library_context.copy_engine_started && size >= threshold) {
+		memory_copy_engine_init(e, MEMORY_COPY_DEFAULT_HELPERS, threshold);
+		for (u32 i = 0; i < e->helper_count; i++) {
+			u8 buffer[256];
+			Arena arena = {.beg = buffer, .end = buffer + countof(buffer)};
+			/* NOTE(rnp): linux limits thread names to 15 characters */
+			Stream name = arena_stream(arena);
+			stream_append_s8(&name, s8("[bf copy "));
+			stream_append_u64(&name, i);
+			stream_append_byte(&name, ']');
+			os_create_thread(arena, (iptr)(e->helpers + i), arena_stream_commit_zero(&arena, &name),
+			                 memory_copy_helper_entry_point);
+		}
+		g_beamformer_library_context.copy_engine_started = 1;
+	}
+	e->threshold = threshold;
+	memory_copy(e, dest, src, size);
+}
+
+/* NOTE(rnp): a broken connection stays in remote mode so that later calls report the
+ * failure instead of quietly going to a local beamformer */
+function void
+remote_close(void)
+{
+	if (g_beamformer_library_context.remote_socket != INVALID_FILE)
+		os_socket_close(g_beamformer_library_context.remote_socket);
+	g_beamformer_library_context.remote_socket = INVALID_FILE;
+}
+
+function b32
+remote_check_reply(BeamformerRemoteHeader *request, BeamformerRemoteHeader *reply)
+{
+	b32 result = os_socket_receive(g_beamformer_library_context.remote_socket, reply, sizeof(*reply)) &&
+	             reply->kind == request->kind;
+	if (!lib_error_check(result, BF_LIB_ERR_KIND_REMOTE_CONNECTION))
+		remote_close();
+	else if (reply->failed)
+		g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_REMOTE_REQUEST;
+	return result;
+}
+
+function b32
+remote_send(BeamformerRemoteHeader *header, void *payload)
+{
+	b32 result = lib_error_check(g_beamformer_library_context.remote_socket != INVALID_FILE &&
+	                             beamformer_remote_send(g_beamformer_library_context.remote_socket, header, payload),
+	                             BF_LIB_ERR_KIND_REMOTE_CONNECTION);
+	if (!result) remote_close();
+	return result;
+}
+
+function b32
+remote_export(BeamformerExportContext export_context, void *out, u64 size, i32 timeout_ms)
+{
+	BeamformerRemoteHeader request = {
+		.kind      = BeamformerRemoteMessageKind_Export,
+		.arguments = {export_context.kind, export_context.size, (u32)timeout_ms},
+	};
+	BeamformerRemoteHeader reply;
+	b32 result = remote_send(&request, 0) && remote_check_reply(&request, &reply);
+	if (result) {
+		iptr handle   = g_beamformer_library_context.remote_socket;
+		b32  fits     = reply.payload_size <= size;
+		b32  received = fits ? os_socket_receive(handle, out, reply.payload_size)
+		                     : beamformer_remote_discard(handle, reply.payload_size);
+		if (!lib_error_check(received, BF_LIB_ERR_KIND_REMOTE_CONNECTION)) remote_close();
+		result = received && lib_error_check(fits, BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW) &&
+		         lib_error_check(reply.arguments[0] != 0, BF_LIB_ERR_KIND_REMOTE_REQUEST);
+	}
+	return result;
+}
+
 u32
 beamformer_get_api_version(void)
 {
@@ -208,18 +325,58 @@ beamformer_set_global_timeout(i32 timeout_ms)
 	return result;
 }
 
+void
+beamformer_set_parallel_copy_threshold(u32 bytes)
+{
+	g_beamformer_library_context.copy_threshold = bytes;
+}
+
+void
+beamformer_disconnect(void)
+{
+	if (g_beamformer_library_context.remote) remote_close();
+	g_beamformer_library_context.remote = 0;
+}
+
+b32
+beamformer_connect(char *address)
+{
+	beamformer_disconnect();
+	iptr handle = os_socket_open(address, 0);
+	b32 result  = lib_error_check(handle != INVALID_FILE, BF_LIB_ERR_KIND_REMOTE_CONNECTION);
+	if (result) {
+		g_beamformer_library_context.remote_socket = handle;
+		g_beamformer_library_context.remote        = 1;
+		zero_struct(&g_beamformer_library_context.remote_export_options);
+
+		BeamformerRemoteHeader request = {
+			.kind      = BeamformerRemoteMessageKind_Hello,
+			.arguments = {BEAMFORMER_SHARED_MEMORY_VERSION},
+		};
+		BeamformerRemoteHeader reply;
+		result = remote_send(&request, 0) && remote_check_reply(&request, &reply) &&
+		         lib_error_check(reply.arguments[0] != 0, BF_LIB_ERR_KIND_VERSION_MISMATCH);
+		if (!result) beamformer_disconnect();
+	}
+	return result;
+}
+
 b32
 beamformer_reserve_parameter_blocks(uint32_t count)
 {
 	b32 result = 0;
-	if (check_shared_memory() &&
-	    lib_error_check(os_reserve_region_locks(g_beamformer_library_context.shared_memory.os_context, count),
-	                    BF_LIB_ERR_KIND_PARAMETER_BLOCK_OVERFLOW))
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {.kind = BeamformerRemoteMessageKind_ReserveParameterBlocks, .arguments = {count}};
+		result = lib_error_check(count <= BeamformerMaxParameterBlockSlots, BF_LIB_ERR_KIND_PARAMETER_BLOCK_OVERFLOW) &&
+		         remote_send(&header, 0);
+	} else if (check_shared_memory() &&
+	           lib_error_check(os_reserve_region_locks(g_beamformer_library_context.shared_memory.os_context, count),
+	                           BF_LIB_ERR_KIND_PARAMETER_BLOCK_OVERFLOW))
 	{
 		u32 old_count = g_beamformer_library_context.bp->reserved_parameter_blocks;
 		g_beamformer_library_context.bp->reserved_parameter_blocks = count;
 		for (u32 i = old_count; i < count; i++)
-			zero_struct(beamformer_parameter_block(g_beamformer_library_context.bp, i));
+			reset_parameter_block(g_beamformer_library_context.bp, i);
 		result = 1;
 	}
 	return result;
@@ -228,31 +385,22 @@ beamformer_reserve_parameter_blocks(uint32_t count)
 function b32
 validate_pipeline(i32 *shaders, u32 shader_count, BeamformerDataKind data_kind)
 {
-	b32 result = lib_error_check(shader_count <= BeamformerMaxComputeShaderStages, BF_LIB_ERR_KIND_COMPUTE_STAGE_OVERFLOW);
-	if (result) {
-		for (u32 i = 0; i < shader_count; i++)
-			result &= BETWEEN(shaders[i], BeamformerShaderKind_ComputeFirst, BeamformerShaderKind_ComputeLast);
-		if (!result) {
-			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_INVALID_COMPUTE_STAGE;
-		} else if (shaders[0] != BeamformerShaderKind_Demodulate &&
-		           shaders[0] != BeamformerShaderKind_Decode)
-		{
-			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_INVALID_START_SHADER;
-			result = 0;
-		} else if (shaders[0] == BeamformerShaderKind_Demodulate &&
-		           !(data_kind == BeamformerDataKind_Int16 || data_kind == BeamformerDataKind_Float32))
-		{
-			g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_INVALID_DEMOD_DATA_KIND;
-			result = 0;
-		}
-	}
+	read_only local_persist BeamformerLibErrorKind errors[] = {
+		[BeamformerPipelineCheck_StageOverflow]        = BF_LIB_ERR_KIND_COMPUTE_STAGE_OVERFLOW,
+		[BeamformerPipelineCheck_InvalidStage]         = BF_LIB_ERR_KIND_INVALID_COMPUTE_STAGE,
+		[BeamformerPipelineCheck_InvalidStartShader]   = BF_LIB_ERR_KIND_INVALID_START_SHADER,
+		[BeamformerPipelineCheck_InvalidDemodDataKind] = BF_LIB_ERR_KIND_INVALID_DEMOD_DATA_KIND,
+	};
+	BeamformerPipelineCheck check = beamformer_check_pipeline(shaders, shader_count, data_kind);
+	b32 result = check == BeamformerPipelineCheck_Valid;
+	if (!result) g_beamformer_library_context.last_error = errors[check];
 	return result;
 }
 
 function b32
 validate_simple_parameters(BeamformerSimpleParameters *bp)
 {
-	b32 result = check_shared_memory();
+	b32 result = g_beamformer_library_context.remote || check_shared_memory();
 	if (result) {
 		result &= bp->channel_count <= BeamformerMaxChannelCount;
 		if (!result)
@@ -265,13 +413,23 @@ function b32
 parameter_block_region_upload_explicit(void *data, u32 size, u32 block, BeamformerParameterBlockRegions region_id,
                                        u32 block_offset, i32 timeout_ms)
 {
-	i32 lock   = BeamformerSharedMemoryLockKind_Count + (i32)block;
-	b32 result = valid_parameter_block(block) && lib_try_lock(lock, timeout_ms);
-	if (result) {
-		mem_copy((u8 *)beamformer_parameter_block(g_beamformer_library_context.bp, block) + block_offset,
-		         data, size);
-		mark_parameter_block_region_dirty(g_beamformer_library_context.bp, block, region_id);
-		lib_release_lock(lock);
+	b32 result = 0;
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {
+			.kind         = BeamformerRemoteMessageKind_ParameterUpload,
+			.arguments    = {block, region_id, block_offset},
+			.payload_size = size,
+		};
+		result = remote_send(&header, data);
+	} else {
+		i32 lock = BeamformerSharedMemoryLockKind_Count + (i32)block;
+		result   = valid_parameter_block(block) && lib_try_lock(lock, timeout_ms);
+		if (result) {
+			mem_copy((u8 *)beamformer_parameter_block(g_beamformer_library_context.bp, block) + block_offset,
+			         data, size);
+			publish_parameter_block_region(g_beamformer_library_context.bp, block, region_id);
+			lib_release_lock(lock);
+		}
 	}
 	return result;
 }
@@ -311,15 +469,22 @@ b32
 beamformer_push_pipeline_at(i32 *shaders, u32 shader_count, BeamformerDataKind data_kind, u32 block)
 {
 	b32 result = 0;
-	if (check_shared_memory() && validate_pipeline(shaders, shader_count, data_kind)) {
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {
+			.kind         = BeamformerRemoteMessageKind_Pipeline,
+			.arguments    = {block, data_kind},
+			.payload_size = shader_count * sizeof(*shaders),
+		};
+		result = validate_pipeline(shaders, shader_count, data_kind) && remote_send(&header, shaders);
+	} else if (check_shared_memory() && validate_pipeline(shaders, shader_count, data_kind)) {
 		i32 lock = BeamformerSharedMemoryLockKind_Count + (i32)block;
 		if (valid_parameter_block(block) && lib_try_lock(lock, g_beamformer_library_context.timeout_ms)) {
 			BeamformerParameterBlock *b = beamformer_parameter_block(g_beamformer_library_context.bp, block);
 			mem_copy(&b->pipeline.shaders, shaders, shader_count * sizeof(*shaders));
-			mark_parameter_block_region_dirty(g_beamformer_library_context.bp, block,
-			                                  BeamformerParameterBlockRegion_ComputePipeline);
 			b->pipeline.shader_count = shader_count;
 			b->pipeline.data_kind    = data_kind;
+			publish_parameter_block_region(g_beamformer_library_context.bp, block,
+			                               BeamformerParameterBlockRegion_ComputePipeline);
 			lib_release_lock(lock);
 			result = 1;
 		}
@@ -338,16 +503,25 @@ function b32
 beamformer_create_filter_base(BeamformerFilterKind kind, BeamformerFilterParameters params, u8 filter_slot, u8 parameter_block)
 {
 	b32 result = 0;
-	if (check_shared_memory()) {
-		BeamformWork *work = try_push_work_queue();
-		if (work) {
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {
+			.kind         = BeamformerRemoteMessageKind_CreateFilter,
+			.arguments    = {kind, filter_slot, parameter_block},
+			.payload_size = sizeof(params),
+		};
+		result = remote_send(&header, &params);
+	} else if (check_shared_memory()) {
+		BeamformWorkPayload *payload;
+		BeamformWork *work = beamform_work_queue_push_with_payload(&g_beamformer_library_context.bp->external_work_queue,
+		                                                           &payload);
+		if (lib_error_check(work != 0, BF_LIB_ERR_KIND_WORK_QUEUE_FULL)) {
 			BeamformerCreateFilterContext *ctx = &work->create_filter_context;
 			work->kind = BeamformerWorkKind_CreateFilter;
+			payload->filter_parameters = params;
 			ctx->kind            = kind;
-			ctx->parameters      = params;
 			ctx->filter_slot     = filter_slot     % BeamformerFilterSlots;
 			ctx->parameter_block = parameter_block % BeamformerMaxParameterBlockSlots;
-			beamform_work_queue_push_commit(&g_beamformer_library_context.bp->external_work_queue);
+			beamform_work_queue_push_commit(&g_beamformer_library_context.bp->external_work_queue, work);
 			result = 1;
 		}
 	}
@@ -386,7 +560,11 @@ function b32
 beamformer_compute_indirect(BeamformerViewPlaneTag tag, u32 block)
 {
 	b32 result = 0;
-	if (check_shared_memory() &&
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {.kind = BeamformerRemoteMessageKind_ComputeIndirect, .arguments = {tag, block}};
+		result = lib_error_check(tag < BeamformerViewPlaneTag_Count, BF_LIB_ERR_KIND_INVALID_IMAGE_PLANE) &&
+		         remote_send(&header, 0);
+	} else if (check_shared_memory() &&
 	    lib_error_check(tag   < BeamformerViewPlaneTag_Count, BF_LIB_ERR_KIND_INVALID_IMAGE_PLANE) &&
 	    lib_error_check(block < g_beamformer_library_context.bp->reserved_parameter_blocks,
 	                    BF_LIB_ERR_KIND_PARAMETER_BLOCK_UNALLOCATED))
@@ -396,7 +574,7 @@ beamformer_compute_indirect(BeamformerViewPlaneTag tag, u32 block)
 			work->kind = BeamformerWorkKind_ComputeIndirect;
 			work->compute_indirect_context.view_plane      = tag;
 			work->compute_indirect_context.parameter_block = block;
-			beamform_work_queue_push_commit(&g_beamformer_library_context.bp->external_work_queue);
+			beamform_work_queue_push_commit(&g_beamformer_library_context.bp->external_work_queue, work);
 			beamformer_flush_commands(0);
 			result = 1;
 		}
@@ -421,6 +599,142 @@ beamformer_wait_for_compute_dispatch(i32 timeout_ms)
 	return result;
 }
 
+u32
+beamformer_completed_frames(u32 parameter_slot)
+{
+	u32 result = 0;
+	if (valid_parameter_block(parameter_slot))
+		result = (u32)atomic_load_u32(g_beamformer_library_context.bp->completed_frames + parameter_slot);
+	return result;
+}
+
+b32
+beamformer_wait_for_completed_frames(u32 parameter_slot, u32 frame_count, i32 timeout_ms)
+{
+	b32 result = 0;
+	if (valid_parameter_block(parameter_slot) &&
+	    lib_error_check(timeout_ms >= -1, BF_LIB_ERR_KIND_INVALID_TIMEOUT))
+	{
+		i32 *completed = g_beamformer_library_context.bp->completed_frames + parameter_slot;
+		/* NOTE(rnp): w32 can't wake a waiter in another process so only wait in short steps */
+		for (i32 waited = 0; timeout_ms == -1 || waited <= timeout_ms; waited++) {
+			i32 current = atomic_load_u32(completed);
+			result = (i32)((u32)current - frame_count) >= 0;
+			if (result || timeout_ms == 0)
+				break;
+			os_wait_on_value(completed, current, 1);
+		}
+		lib_error_check(result, BF_LIB_ERR_KIND_COMPLETION_TIMEOUT);
+	}
+	return result;
+}
+
+b32
+beamformer_set_export_options(BeamformerExportOptions *options)
+{
+	b32 result = 0;
+	if ((g_beamformer_library_context.remote || check_shared_memory()) &&
+	    lib_error_check(options->processing < BeamformerExportProcessing_Count &&
+	                    (options->processing < BeamformerExportProcessing_Decibel8 || options->dynamic_range > 0),
+	                    BF_LIB_ERR_KIND_INVALID_EXPORT_OPTIONS))
+	{
+		if (g_beamformer_library_context.remote) {
+			BeamformerRemoteHeader header = {
+				.kind         = BeamformerRemoteMessageKind_ExportOptions,
+				.payload_size = sizeof(*options),
+			};
+			result = remote_send(&header, options);
+			if (result) g_beamformer_library_context.remote_export_options = *options;
+		} else {
+			g_beamformer_library_context.bp->export_options = *options;
+			memory_write_barrier();
+			result = 1;
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_set_export_stream(u32 enabled)
+{
+	b32 result = check_shared_memory();
+	if (result) {
+		g_beamformer_library_context.export_stream_requested = enabled != 0;
+		atomic_store_u32(&g_beamformer_library_context.bp->export_stream_enabled,
+		                 enabled != 0 || g_beamformer_library_context.tickets_pending > 0);
+	}
+	return result;
+}
+
+function void
+beamformer_ticket_retire(BeamformerTicket *t)
+{
+	t->pending = 0;
+	if (--g_beamformer_library_context.tickets_pending == 0) {
+		atomic_store_u32(&g_beamformer_library_context.bp->export_stream_enabled,
+		                 g_beamformer_library_context.export_stream_requested);
+	}
+}
+
+u32
+beamformer_export_stream_next_frame(void)
+{
+	u32 result = 0;
+	if (check_shared_memory())
+		result = atomic_load_u32(&g_beamformer_library_context.bp->export_stream_write_index);
+	return result;
+}
+
+b32
+beamformer_export_stream_read(u32 frame_number, void *out, u64 out_size, BeamformerExportFrameInfo *info, i32 timeout_ms)
+{
+	b32 result = 0;
+	if (check_shared_memory() && lib_error_check(timeout_ms >= -1, BF_LIB_ERR_KIND_INVALID_TIMEOUT)) {
+		BeamformerSharedMemory *sm   = g_beamformer_library_context.bp;
+		u32                   index = frame_number % BEAMFORMER_EXPORT_SLOT_COUNT;
+		BeamformerExportSlot *slot  = sm->export_slots + index;
+
+		b32 overwritten = 0, overflow = 0;
+		for (i32 waited = 0; !result && !overwritten && !overflow && (timeout_ms == -1 || waited <= timeout_ms); waited++) {
+			/* NOTE(rnp): frames this far behind the writer may already be gone */
+			u32 written = atomic_load_u32(&sm->export_stream_write_index);
+			overwritten = (i32)(written - frame_number) > BEAMFORMER_EXPORT_SLOT_COUNT;
+
+			i32 sequence = atomic_load_u32(&slot->sequence);
+			if (!overwritten && (sequence & 1) == 0) {
+				BeamformerExportFrameInfo slot_info = slot->info;
+				if (slot_info.frame_number == frame_number && (i32)(written - frame_number) > 0) {
+					overflow = slot_info.size > out_size;
+					if (!overflow) {
+						mem_copy(out, beamformer_export_slot_data(sm, index), slot_info.size);
+						/* NOTE(rnp): writer started on this slot while we were copying; the data
+						 * now belongs to a newer frame */
+						if (atomic_load_u32(&slot->sequence) == sequence) {
+							if (info) *info = slot_info;
+							result = 1;
+						} else {
+							overwritten = 1;
+						}
+					}
+				} else if ((i32)(slot_info.frame_number - frame_number) > 0 && (i32)(written - frame_number) > 0) {
+					overwritten = 1;
+				}
+			}
+
+			if (!result && !overwritten && !overflow) {
+				if (timeout_ms == 0) break;
+				/* NOTE(rnp): w32 can't wake a waiter in another process so only wait in short steps */
+				os_wait_on_value(&slot->sequence, sequence, 1);
+			}
+		}
+
+		if (overwritten)     g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_EXPORT_FRAME_OVERWRITTEN;
+		else if (overflow)   g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW;
+		else if (!result)    g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_COMPLETION_TIMEOUT;
+	}
+	return result;
+}
+
 #define BEAMFORMER_UPLOAD_FNS \
 	X(channel_mapping, i16, 1, ChannelMapping) \
 	X(sparse_elements, i16, 1, SparseElements) \
@@ -448,17 +762,32 @@ BEAMFORMER_UPLOAD_FNS
 #undef X
 
 function b32
-beamformer_push_data_base(void *data, u32 data_size, i32 timeout_ms)
+beamformer_push_data_base(void *data, u32 frame_size, u32 frame_count, i32 timeout_ms)
 {
 	b32 result = 0;
-	if (check_shared_memory()) {
-		Arena scratch = beamformer_shared_memory_scratch_arena(g_beamformer_library_context.bp);
-		if (lib_error_check(data_size <= arena_capacity(&scratch, u8), BF_LIB_ERR_KIND_BUFFER_OVERFLOW)) {
+	if (g_beamformer_library_context.remote) {
+		/* NOTE(rnp): the beamformer receives this directly into an RF slot */
+		BeamformerRemoteHeader header = {
+			.kind         = BeamformerRemoteMessageKind_RFData,
+			.arguments    = {frame_size, frame_count, BeamformerRFEncoding_None},
+			.payload_size = (u64)frame_size * frame_count,
+		};
+		result = lib_error_check(frame_count > 0 && header.payload_size + 64 <= BEAMFORMER_RF_SLOT_SIZE,
+		                         BF_LIB_ERR_KIND_BUFFER_OVERFLOW) &&
+		         remote_send(&header, data);
+	} else if (check_shared_memory()) {
+		Arena scratch  = beamformer_shared_memory_scratch_arena(g_beamformer_library_context.bp);
+		u64 data_size  = (u64)frame_size * frame_count;
+		if (lib_error_check(frame_count > 0 && data_size <= (u64)arena_capacity(&scratch, u8) &&
+		                    data_size <= U32_MAX, BF_LIB_ERR_KIND_BUFFER_OVERFLOW))
+		{
 			if (lib_try_lock(BeamformerSharedMemoryLockKind_UploadRF, timeout_ms)) {
 				if (lib_try_lock(BeamformerSharedMemoryLockKind_ScratchSpace, 0)) {
-					mem_copy(scratch.beg, data, data_size);
+					lib_memory_copy(scratch.beg, data, (uz)data_size);
 					/* TODO(rnp): need a better way to communicate this */
-					g_beamformer_library_context.bp->scratch_rf_size = data_size;
+					g_beamformer_library_context.bp->scratch_rf_size        = frame_size;
+					g_beamformer_library_context.bp->scratch_rf_frame_count = frame_count;
+					g_beamformer_library_context.bp->scratch_rf_encoding    = BeamformerRFEncoding_None;
 					lib_release_lock(BeamformerSharedMemoryLockKind_ScratchSpace);
 					result = 1;
 				}
@@ -471,17 +800,154 @@ beamformer_push_data_base(void *data, u32 data_size, i32 timeout_ms)
 b32
 beamformer_push_data(void *data, u32 data_size)
 {
-	return beamformer_push_data_base(data, data_size, g_beamformer_library_context.timeout_ms);
+	return beamformer_push_data_base(data, data_size, 1, g_beamformer_library_context.timeout_ms);
 }
 
 b32
 beamformer_push_data_with_compute(void *data, u32 data_size, u32 image_plane_tag, u32 parameter_slot)
 {
-	b32 result = beamformer_push_data_base(data, data_size, g_beamformer_library_context.timeout_ms);
+	b32 result = beamformer_push_data_base(data, data_size, 1, g_beamformer_library_context.timeout_ms);
+	if (result) result = beamformer_compute_indirect(image_plane_tag, parameter_slot);
+	return result;
+}
+
+b32
+beamformer_push_frames_with_compute(void *data, u32 frame_size, u32 frame_count,
+                                    u32 image_plane_tag, u32 parameter_slot)
+{
+	b32 result = beamformer_push_data_base(data, frame_size, frame_count, g_beamformer_library_context.timeout_ms);
+	if (result) result = beamformer_compute_indirect(image_plane_tag, parameter_slot);
+	return result;
+}
+
+b32
+beamformer_rf_slot_acquire(u32 frame_size, u32 frame_count, u32 *slot_index, void **data, i32 timeout_ms)
+{
+	b32 result = 0;
+	u64 data_size = (u64)frame_size * frame_count;
+	/* NOTE(rnp): the upload reads each frame rounded up to 64 bytes */
+	if (check_shared_memory() &&
+	    lib_error_check(frame_count > 0 && data_size + 64 <= BEAMFORMER_RF_SLOT_SIZE, BF_LIB_ERR_KIND_BUFFER_OVERFLOW) &&
+	    lib_error_check(timeout_ms >= -1, BF_LIB_ERR_KIND_INVALID_TIMEOUT))
+	{
+		BeamformerSharedMemory *sm = g_beamformer_library_context.bp;
+		for (i32 waited = 0; !result && (timeout_ms == -1 || waited <= timeout_ms); waited++) {
+			i32 slot = beamformer_rf_slot_try_acquire(sm, frame_size, frame_count);
+			if (slot >= 0) {
+				*slot_index = (u32)slot;
+				*data       = beamformer_rf_slot_data(sm, (u32)slot);
+				result      = 1;
+			} else if (timeout_ms != 0) {
+				beamformer_rf_slot_wait(sm, 1);
+			}
+		}
+		lib_error_check(result, BF_LIB_ERR_KIND_SYNC_VARIABLE);
+	}
+	return result;
+}
+
+b32
+beamformer_rf_slot_release(u32 slot_index)
+{
+	b32 result = check_shared_memory() &&
+	             lib_error_check(slot_index < BEAMFORMER_RF_SLOT_COUNT, BF_LIB_ERR_KIND_INVALID_RF_SLOT);
+	if (result) {
+		i32 state = BeamformerRFSlotState_Filling;
+		result = lib_error_check(atomic_cas_u32(&g_beamformer_library_context.bp->rf_slots[slot_index].state,
+		                                        &state, BeamformerRFSlotState_Ready),
+		                         BF_LIB_ERR_KIND_INVALID_RF_SLOT);
+	}
+	return result;
+}
+
+b32
+beamformer_rf_slot_release_with_compute(u32 slot_index, u32 image_plane_tag, u32 parameter_slot)
+{
+	b32 result = beamformer_rf_slot_release(slot_index);
 	if (result) result = beamformer_compute_indirect(image_plane_tag, parameter_slot);
 	return result;
 }
 
+function b32
+valid_rf_encoding(BeamformerRFEncoding encoding, u32 sample_count)
+{
+	b32 result = lib_error_check(encoding > BeamformerRFEncoding_None && encoding < BeamformerRFEncoding_Count,
+	                             BF_LIB_ERR_KIND_INVALID_RF_ENCODING) &&
+	             lib_error_check(sample_count > 0 && (u64)sample_count * sizeof(i16) <= U32_MAX,
+	                             BF_LIB_ERR_KIND_BUFFER_OVERFLOW);
+	return result;
+}
+
+u64
+beamformer_encoded_size_bound(BeamformerRFEncoding encoding, u32 sample_count)
+{
+	u64 result = rf_encoded_size_bound(encoding, sample_count);
+	return result;
+}
+
+u32
+beamformer_encode_rf(i16 *samples, u32 sample_count, BeamformerRFEncoding encoding, void *out, u32 out_capacity)
+{
+	u32 result = 0;
+	if (valid_rf_encoding(encoding, sample_count)) {
+		result = (u32)rf_encode(encoding, out, out_capacity, samples, sample_count);
+		lib_error_check(result != 0, BF_LIB_ERR_KIND_BUFFER_OVERFLOW);
+	}
+	return result;
+}
+
+b32
+beamformer_push_encoded_data_with_compute(void *data, u32 data_size, u32 sample_count, BeamformerRFEncoding encoding,
+                                          u32 image_plane_tag, u32 parameter_slot)
+{
+	b32 result = 0;
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {
+			.kind         = BeamformerRemoteMessageKind_RFData,
+			.arguments    = {data_size, 1, encoding, sample_count},
+			.payload_size = data_size,
+		};
+		result = valid_rf_encoding(encoding, sample_count) &&
+		         lib_error_check(data_size + 64 <= BEAMFORMER_RF_SLOT_SIZE, BF_LIB_ERR_KIND_BUFFER_OVERFLOW) &&
+		         remote_send(&header, data) && beamformer_compute_indirect(image_plane_tag, parameter_slot);
+	} else if (check_shared_memory() && valid_rf_encoding(encoding, sample_count)) {
+		Arena scratch = beamformer_shared_memory_scratch_arena(g_beamformer_library_context.bp);
+		if (lib_error_check(data_size <= (u64)arena_capacity(&scratch, u8), BF_LIB_ERR_KIND_BUFFER_OVERFLOW) &&
+		    lib_try_lock(BeamformerSharedMemoryLockKind_UploadRF, g_beamformer_library_context.timeout_ms))
+		{
+			if (lib_try_lock(BeamformerSharedMemoryLockKind_ScratchSpace, 0)) {
+				lib_memory_copy(scratch.beg, data, data_size);
+				g_beamformer_library_context.bp->scratch_rf_size         = sample_count * (u32)sizeof(i16);
+				g_beamformer_library_context.bp->scratch_rf_frame_count  = 1;
+				g_beamformer_library_context.bp->scratch_rf_encoding     = encoding;
+				g_beamformer_library_context.bp->scratch_rf_encoded_size = data_size;
+				lib_release_lock(BeamformerSharedMemoryLockKind_ScratchSpace);
+				result = beamformer_compute_indirect(image_plane_tag, parameter_slot);
+			}
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_rf_slot_set_encoding(u32 slot_index, BeamformerRFEncoding encoding, u32 sample_count)
+{
+	b32 result = check_shared_memory() &&
+	             lib_error_check(slot_index < BEAMFORMER_RF_SLOT_COUNT, BF_LIB_ERR_KIND_INVALID_RF_SLOT) &&
+	             valid_rf_encoding(encoding, sample_count);
+	if (result) {
+		BeamformerRFSlot *slot = g_beamformer_library_context.bp->rf_slots + slot_index;
+		result = lib_error_check(atomic_load_u32(&slot->state) == BeamformerRFSlotState_Filling &&
+		                         slot->frame_count == 1, BF_LIB_ERR_KIND_INVALID_RF_SLOT);
+		if (result) {
+			slot->encoding     = encoding;
+			slot->encoded_size = slot->frame_size;
+			slot->frame_size   = sample_count * (u32)sizeof(i16);
+		}
+	}
+	return result;
+}
+
 b32
 beamformer_push_parameters_at(BeamformerParameters *bp, u32 block)
 {
@@ -548,13 +1014,21 @@ beamformer_push_parameters_head(BeamformerParametersHead *bp)
 function b32
 beamformer_export_buffer(BeamformerExportContext export_context)
 {
-	BeamformWork *work = try_push_work_queue();
-	b32 result = work && lib_try_lock(BeamformerSharedMemoryLockKind_ExportSync, 0);
+	/* NOTE(rnp): take the lock first; pushed work can't be taken back if the lock fails */
+	b32 result = lib_try_lock(BeamformerSharedMemoryLockKind_ExportSync, 0);
 	if (result) {
-		work->export_context = export_context;
-		work->kind = BeamformerWorkKind_ExportBuffer;
-		work->lock = BeamformerSharedMemoryLockKind_ScratchSpace;
-		beamform_work_queue_push_commit(&g_beamformer_library_context.bp->external_work_queue);
+		BeamformWork *work = try_push_work_queue();
+		if (work) {
+			BeamformerSharedMemory *sm = g_beamformer_library_context.bp;
+			sm->export_buffer_options = sm->export_options;
+			work->export_context = export_context;
+			work->kind = BeamformerWorkKind_ExportBuffer;
+			work->lock = BeamformerSharedMemoryLockKind_ScratchSpace;
+			beamform_work_queue_push_commit(&g_beamformer_library_context.bp->external_work_queue, work);
+		} else {
+			lib_release_lock(BeamformerSharedMemoryLockKind_ExportSync);
+		}
+		result = work != 0;
 	}
 	return result;
 }
@@ -575,6 +1049,23 @@ beamformer_read_output(void *out, iz size, i32 timeout_ms)
 	return result;
 }
 
+function u32
+output_voxel_size(i32 *shaders, u32 shader_count, i32 output_data_kind)
+{
+	b32 complex = 0;
+	for (u32 stage = 0; stage < shader_count; stage++) {
+		BeamformerShaderKind shader = (BeamformerShaderKind)shaders[stage];
+		complex |= shader == BeamformerShaderKind_Demodulate || shader == BeamformerShaderKind_CudaHilbert;
+	}
+
+	b32 half = output_data_kind == BeamformerDataKind_Float16 ||
+	           output_data_kind == BeamformerDataKind_Float16Complex;
+
+	u32 result = half ? sizeof(u16) : sizeof(f32);
+	if (complex) result *= 2;
+	return result;
+}
+
 b32
 beamformer_beamform_data(BeamformerSimpleParameters *bp, void *data, uint32_t data_size,
                          void *out_data, int32_t timeout_ms)
@@ -587,31 +1078,155 @@ beamformer_beamform_data(BeamformerSimpleParameters *bp, void *data, uint32_t da
 
 		beamformer_push_simple_parameters(bp);
 
-		b32 complex = 0;
-		for (u32 stage = 0; stage < bp->compute_stages_count; stage++) {
-			BeamformerShaderKind shader = (BeamformerShaderKind)bp->compute_stages[stage];
-			complex |= shader == BeamformerShaderKind_Demodulate || shader == BeamformerShaderKind_CudaHilbert;
-		}
+		u32 voxel_size = output_voxel_size(bp->compute_stages, bp->compute_stages_count, bp->output_data_kind);
+		BeamformerExportOptions *export_options = &g_beamformer_library_context.remote_export_options;
+		if (!g_beamformer_library_context.remote) export_options = &g_beamformer_library_context.bp->export_options;
+		BeamformerExportRegion region = beamformer_export_region(export_options, bp->output_points, voxel_size);
+		iz output_size = (iz)region.size;
+
+		BeamformerExportContext export;
+		export.kind = BeamformerExportKind_BeamformedData;
+		export.size = (u32)output_size;
+
+		if (g_beamformer_library_context.remote) {
+			/* NOTE(rnp): the beamformer checks the size against its scratch space */
+			result = lib_error_check(region.size <= U32_MAX, BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW) &&
+			         beamformer_push_data_with_compute(data, data_size, 0, 0) &&
+			         remote_export(export, out_data, region.size, timeout_ms);
+		} else {
+			Arena scratch = beamformer_shared_memory_scratch_arena(g_beamformer_library_context.bp);
+			if (lib_error_check(output_size <= arena_capacity(&scratch, u8), BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW)
+			    && beamformer_push_data_with_compute(data, data_size, 0, 0))
+			{
+				if (beamformer_export_buffer(export)) {
+					/* NOTE(rnp): if this fails it just means that the work from push_data hasn't
+					 * started yet. This is here to catch the other case where the work started
+					 * and finished before we finished queuing the export work item */
+					beamformer_flush_commands(0);
 
-		iz output_size = bp->output_points[0] * bp->output_points[1] * bp->output_points[2] * (i32)sizeof(f32);
-		if (complex) output_size *= 2;
+					result = beamformer_read_output(out_data, output_size, timeout_ms);
+				}
+			}
+		}
+	}
+	return result;
+}
 
-		Arena scratch = beamformer_shared_memory_scratch_arena(g_beamformer_library_context.bp);
-		if (result && lib_error_check(output_size <= arena_capacity(&scratch, u8), BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW)
-		    && beamformer_push_data_with_compute(data, data_size, 0, 0))
+b32
+beamformer_beamform_submit(void *data, u32 data_size, u32 parameter_slot, u32 *ticket)
+{
+	b32 result = 0;
+	if (check_shared_memory() && valid_parameter_block(parameter_slot)) {
+		BeamformerSharedMemory *sm = g_beamformer_library_context.bp;
+		u32 ticket_id = g_beamformer_library_context.ticket_write_index;
+		BeamformerTicket *t = g_beamformer_library_context.tickets + ticket_id % BEAMFORMER_EXPORT_SLOT_COUNT;
+
+		/* NOTE(rnp): frames which won't fit in an export slot are never streamed. the
+		 * published copy is what the beamformer will use; the staging copy may be mid update */
+		BeamformerParameterBlock pb;
+		beamformer_parameter_block_snapshot(sm, parameter_slot, &pb);
+		u32 voxel_size = output_voxel_size((i32 *)pb.pipeline.shaders, pb.pipeline.shader_count,
+		                                   pb.parameters.output_data_kind);
+		i32 points[3] = {pb.parameters.output_points[0], pb.parameters.output_points[1],
+		                 pb.parameters.output_points[2]};
+		BeamformerExportRegion region = beamformer_export_region(&sm->export_options, points, voxel_size);
+
+		if (lib_error_check(!t->pending, BF_LIB_ERR_KIND_TICKETS_EXHAUSTED) &&
+		    lib_error_check(region.size <= BEAMFORMER_EXPORT_SLOT_SIZE, BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW))
 		{
-			BeamformerExportContext export;
-			export.kind = BeamformerExportKind_BeamformedData;
-			export.size = (u32)output_size;
-			if (beamformer_export_buffer(export)) {
-				/* NOTE(rnp): if this fails it just means that the work from push_data hasn't
-				 * started yet. This is here to catch the other case where the work started
-				 * and finished before we finished queuing the export work item */
-				beamformer_flush_commands(0);
-
-				result = beamformer_read_output(out_data, output_size, timeout_ms);
+			/* NOTE(rnp): once every earlier frame for the block has completed the next frame
+			 * is the block's current count; otherwise it follows the last ticket's frame */
+			u32  completed  = (u32)atomic_load_u32(sm->completed_frames + parameter_slot);
+			u32 *next_frame = g_beamformer_library_context.ticket_next_frame + parameter_slot;
+			if ((i32)(completed - *next_frame) > 0) *next_frame = completed;
+
+			if (g_beamformer_library_context.tickets_pending == 0)
+				g_beamformer_library_context.export_stream_requested = atomic_load_u32(&sm->export_stream_enabled);
+			atomic_store_u32(&sm->export_stream_enabled, 1);
+
+			result = beamformer_push_data_with_compute(data, data_size, 0, parameter_slot);
+			if (result) {
+				t->ticket          = ticket_id;
+				t->parameter_block = parameter_slot;
+				t->frame           = (*next_frame)++;
+				t->pending         = 1;
+				g_beamformer_library_context.tickets_pending++;
+				g_beamformer_library_context.ticket_write_index++;
+				*ticket = ticket_id;
+			} else if (g_beamformer_library_context.tickets_pending == 0) {
+				atomic_store_u32(&sm->export_stream_enabled, g_beamformer_library_context.export_stream_requested);
+			}
+		}
+	}
+	return result;
+}
+
+b32
+beamformer_beamform_wait(u32 ticket, void *out, u64 out_size, BeamformerExportFrameInfo *info, i32 timeout_ms)
+{
+	b32 result = 0;
+	BeamformerTicket *t = g_beamformer_library_context.tickets + ticket % BEAMFORMER_EXPORT_SLOT_COUNT;
+	if (check_shared_memory() && lib_error_check(timeout_ms >= -1, BF_LIB_ERR_KIND_INVALID_TIMEOUT) &&
+	    lib_error_check(t->pending && t->ticket == ticket, BF_LIB_ERR_KIND_INVALID_TICKET))
+	{
+		BeamformerSharedMemory *sm = g_beamformer_library_context.bp;
+		i32 *completed = sm->completed_frames + t->parameter_block;
+
+		b32 overwritten = 0, overflow = 0;
+		for (i32 waited = 0; !result && !overwritten && !overflow && (timeout_ms == -1 || waited <= timeout_ms); waited++) {
+			/* NOTE(rnp): the count is read first; once it passes the frame its slot info has
+			 * been written so if no slot holds it (and none is being written) it is gone */
+			i32 current = atomic_load_u32(completed);
+			b32 done    = (i32)((u32)current - t->frame) > 0;
+
+			/* NOTE(rnp): info in a slot with an odd sequence may be half written */
+			BeamformerExportSlot *busy = 0;
+			i32 busy_sequence = 0;
+			for (u32 index = 0; !result && !overflow && index < BEAMFORMER_EXPORT_SLOT_COUNT; index++) {
+				BeamformerExportSlot *slot = sm->export_slots + index;
+				for (;;) {
+					i32 sequence = atomic_load_u32(&slot->sequence);
+					BeamformerExportFrameInfo slot_info = slot->info;
+					memory_read_barrier();
+					if (atomic_load_u32(&slot->sequence) != sequence)
+						continue;
+
+					if (sequence & 1) {
+						busy          = slot;
+						busy_sequence = sequence;
+					} else if (slot_info.parameter_block       == t->parameter_block &&
+					           slot_info.parameter_block_frame == t->frame)
+					{
+						overflow = slot_info.size > out_size;
+						if (!overflow) {
+							mem_copy(out, beamformer_export_slot_data(sm, index), slot_info.size);
+							memory_read_barrier();
+							/* NOTE(rnp): the beamformer started writing a newer frame here while we
+							 * were copying; look at the slot again */
+							if (atomic_load_u32(&slot->sequence) != sequence)
+								continue;
+							if (info) *info = slot_info;
+							result = 1;
+						}
+					}
+					break;
+				}
+			}
+			overwritten = !result && !overflow && !busy && done;
+
+			if (!result && !overwritten && !overflow) {
+				if (timeout_ms == 0) break;
+				/* NOTE(rnp): w32 can't wake a waiter in another process so only wait in short steps */
+				if (busy) os_wait_on_value(&busy->sequence, busy_sequence, 1);
+				else      os_wait_on_value(completed, current, 1);
 			}
 		}
+
+		if (overwritten)     g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_EXPORT_FRAME_OVERWRITTEN;
+		else if (overflow)   g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW;
+		else if (!result)    g_beamformer_library_context.last_error = BF_LIB_ERR_KIND_COMPLETION_TIMEOUT;
+
+		if (result || overwritten) beamformer_ticket_retire(t);
 	}
 	return result;
 }
@@ -622,13 +1237,16 @@ beamformer_compute_timings(BeamformerComputeStatsTable *output, i32 timeout_ms)
 	static_assert(sizeof(*output) <= BEAMFORMER_SHARED_MEMORY_MAX_SCRATCH_SIZE,
 	              "timing table size exceeds scratch space");
 
+	BeamformerExportContext export;
+	export.kind = BeamformerExportKind_Stats;
+	export.size = sizeof(*output);
+
 	b32 result = 0;
-	if (check_shared_memory()) {
+	if (g_beamformer_library_context.remote) {
+		result = remote_export(export, output, sizeof(*output), timeout_ms);
+	} else if (check_shared_memory()) {
 		Arena scratch = beamformer_shared_memory_scratch_arena(g_beamformer_library_context.bp);
 		if (lib_error_check(arena_capacity(&scratch, u8) <= (iz)sizeof(*output), BF_LIB_ERR_KIND_EXPORT_SPACE_OVERFLOW)) {
-			BeamformerExportContext export;
-			export.kind = BeamformerExportKind_Stats;
-			export.size = sizeof(*output);
 			if (beamformer_export_buffer(export) && beamformer_flush_commands(0))
 				result = beamformer_read_output(output, sizeof(*output), timeout_ms);
 		}
@@ -662,7 +1280,13 @@ b32
 beamformer_set_live_parameters(BeamformerLiveImagingParameters *new)
 {
 	b32 result = 0;
-	if (check_shared_memory()) {
+	if (g_beamformer_library_context.remote) {
+		BeamformerRemoteHeader header = {
+			.kind         = BeamformerRemoteMessageKind_LiveParameters,
+			.payload_size = sizeof(*new),
+		};
+		result = remote_send(&header, new);
+	} else if (check_shared_memory()) {
 		mem_copy(&g_beamformer_library_context.bp->live_imaging_parameters, new, sizeof(*new));
 		memory_write_barrier();
 		result = 1;
@@ -26,7 +26,16 @@
 	X(INVALID_TIMEOUT,             15, "invalid timeout value")                         \
 	X(INVALID_FILTER_KIND,         16, "invalid filter kind")                           \
 	X(INVALID_FILTER_PARAM_COUNT,  17, "invalid parameters count passed for filter")    \
-	X(INVALID_SIMPLE_PARAMETERS,   18, "invalid simple parameters struct")
+	X(INVALID_SIMPLE_PARAMETERS,   18, "invalid simple parameters struct")             \
+	X(INVALID_RF_SLOT,             19, "RF slot index invalid or slot not acquired")     \
+	X(INVALID_RF_ENCODING,         20, "invalid RF encoding")                          \
+	X(COMPLETION_TIMEOUT,          21, "frames were not completed within timeout period") \
+	X(EXPORT_FRAME_OVERWRITTEN,    22, "export stream frame was overwritten before it was read") \
+	X(INVALID_EXPORT_OPTIONS,      23, "invalid export processing kind or dynamic range") \
+	X(REMOTE_CONNECTION,           24, "remote beamformer connection failed")          \
+	X(REMOTE_REQUEST,              25, "remote beamformer rejected a request")          \
+	X(TICKETS_EXHAUSTED,           26, "too many beamform tickets waiting to be retrieved") \
+	X(INVALID_TICKET,              27, "beamform ticket invalid or already retrieved")
 
 #define X(type, num, string) BF_LIB_ERR_KIND_ ##type = num,
 typedef enum {BEAMFORMER_LIB_ERRORS} BeamformerLibErrorKind;
@@ -45,6 +54,7 @@ LIB_FN const char *beamformer_error_string(BeamformerLibErrorKind kind);
  *     - filters need to be created with beamformer_create_filter, and the slot
  *       needs to be assigned in compute_stage_parameters
  *   - allocate a buffer with enough space for all Float32 or Float32Complex output points
+ *     (Float16 or Float16Complex when output_data_kind requests half precision output)
  *   - pass the buffer along with the data and parameters to beamformer_beamform_data()
  *   - if the function was unsuccessful you can check the error with beamformer_get_last_error()
  *     or beamformer_get_last_error_string()
@@ -52,6 +62,21 @@ LIB_FN const char *beamformer_error_string(BeamformerLibErrorKind kind);
 LIB_FN uint32_t beamformer_beamform_data(BeamformerSimpleParameters *bp, void *data, uint32_t data_size,
                                          void *out_data, int32_t timeout_ms);
 
+/* NOTE: asynchronous beamforming. parameters are pushed once beforehand (e.g. with
+ * beamformer_push_simple_parameters_at()); submit then only queues data for parameter_slot
+ * and returns a ticket. beamformer_beamform_wait() waits for the ticket's frame and copies
+ * it into out (pass timeout_ms = 0 to poll). frames come back through the export stream, which
+ * submit enables, so export options apply and info describes the frame. only a few frames fit
+ * in the stream: submit fails with BF_LIB_ERR_KIND_TICKETS_EXHAUSTED while the ticket handed
+ * out that many submissions ago hasn't been retrieved. tickets assume no other client pushes
+ * frames for parameter_slot while they are in flight. a ticket is used up once it succeeds or
+ * fails with anything other than a timeout or a too small out_size. the export stream is kept
+ * enabled while any ticket is pending and then returned to its previous state */
+LIB_FN uint32_t beamformer_beamform_submit(void *data, uint32_t data_size, uint32_t parameter_slot,
+                                           uint32_t *ticket);
+LIB_FN uint32_t beamformer_beamform_wait(uint32_t ticket, void *out, uint64_t out_size,
+                                         BeamformerExportFrameInfo *info, int32_t timeout_ms);
+
 /* NOTE: sets timeout for all functions which may timeout but don't
  * take a timeout argument. The majority of such functions will not
  * timeout in the normal case and so passing a timeout parameter around
@@ -62,6 +87,23 @@ LIB_FN uint32_t beamformer_beamform_data(BeamformerSimpleParameters *bp, void *d
  * IMPORTANT: timeout of -1 will block forever */
 LIB_FN uint32_t beamformer_set_global_timeout(int32_t timeout_ms);
 
+/* NOTE: pushed data at least this large is copied into shared memory by a small pool
+ * of helper threads which are started the first time it is needed
+ *
+ * bytes: copy size threshold (Default: 8MB, 0 restores the default) */
+LIB_FN void beamformer_set_parallel_copy_threshold(uint32_t bytes);
+
+/* NOTE: remote beamformer. after connecting parameter, pipeline and filter pushes, RF data,
+ * exports, compute timings and live parameters go over a socket to a beamformer started with
+ * --listen instead of through shared memory. RF slots, the export stream and completed frame
+ * counters still need shared memory. most requests aren't answered so a rejected one is
+ * reported as BF_LIB_ERR_KIND_REMOTE_REQUEST by the next export. once the connection breaks
+ * calls fail with BF_LIB_ERR_KIND_REMOTE_CONNECTION until beamformer_disconnect()
+ *
+ * address: "unix:/path/to/socket" or "ipv4:port" (e.g. "192.168.1.10:7200") */
+LIB_FN uint32_t beamformer_connect(char *address);
+LIB_FN void     beamformer_disconnect(void);
+
 ///////////////////////////
 // NOTE: Advanced API
 
@@ -74,6 +116,29 @@ LIB_FN uint32_t beamformer_start_compute(void);
 /* NOTE: waits for previously queued beamform to start or for timeout_ms */
 LIB_FN uint32_t beamformer_wait_for_compute_dispatch(int32_t timeout_ms);
 
+/* NOTE: each parameter block counts the frames it has finished beamforming (dropped frames
+ * included). the count only increases and wraps around at 2^32. read it before submitting
+ * and wait for it to reach the value you need; submissions can keep going in the meantime.
+ * beamformer_wait_for_completed_frames() returns once the count is at least frame_count */
+LIB_FN uint32_t beamformer_completed_frames(uint32_t parameter_slot);
+LIB_FN uint32_t beamformer_wait_for_completed_frames(uint32_t parameter_slot, uint32_t frame_count,
+                                                     int32_t timeout_ms);
+
+/* NOTE: export stream. when enabled the beamformer writes every completed frame into a small
+ * ring in shared memory instead of requiring an export request per frame. frames are numbered
+ * in the order they complete; beamformer_export_stream_next_frame() returns the number the next
+ * frame will get. beamformer_export_stream_read() waits for that frame and copies it to out.
+ * the ring only holds a few frames so a reader that falls behind gets
+ * BF_LIB_ERR_KIND_EXPORT_FRAME_OVERWRITTEN and should restart from next_frame() */
+LIB_FN uint32_t beamformer_set_export_stream(uint32_t enabled);
+/* NOTE: post processing done on the GPU before data leaves the beamformer. applies to
+ * beamformer_beamform_data(), beamformed data exports and the export stream until changed.
+ * pass a zeroed struct to get back the full frame unmodified */
+LIB_FN uint32_t beamformer_set_export_options(BeamformerExportOptions *options);
+LIB_FN uint32_t beamformer_export_stream_next_frame(void);
+LIB_FN uint32_t beamformer_export_stream_read(uint32_t frame_number, void *out, uint64_t out_size,
+                                              BeamformerExportFrameInfo *info, int32_t timeout_ms);
+
 /* NOTE: this function only queue an upload; you must flush (start_compute) */
 LIB_FN uint32_t beamformer_push_data(void *data, uint32_t size);
 
@@ -82,9 +147,47 @@ LIB_FN uint32_t beamformer_push_data_with_compute(void *data, uint32_t size,
                                                   uint32_t image_plane_tag,
                                                   uint32_t parameter_slot);
 
+/* NOTE: pushes frame_count frames of frame_size bytes, packed back to back in data, with
+ * a single upload and queues a compute which beamforms each of them into its own frame */
+LIB_FN uint32_t beamformer_push_frames_with_compute(void *data, uint32_t frame_size,
+                                                    uint32_t frame_count,
+                                                    uint32_t image_plane_tag,
+                                                    uint32_t parameter_slot);
+
+/* NOTE: zero copy alternative to the push functions above. acquire a slot in shared memory,
+ * write frame_count frames of frame_size bytes directly into data and then release it.
+ * slots are uploaded in the order they were acquired; when queueing a compute release them
+ * in that same order. acquire only blocks when every slot is still waiting to be uploaded */
+LIB_FN uint32_t beamformer_rf_slot_acquire(uint32_t frame_size, uint32_t frame_count,
+                                           uint32_t *slot_index, void **data, int32_t timeout_ms);
+LIB_FN uint32_t beamformer_rf_slot_release(uint32_t slot_index);
+LIB_FN uint32_t beamformer_rf_slot_release_with_compute(uint32_t slot_index,
+                                                        uint32_t image_plane_tag,
+                                                        uint32_t parameter_slot);
+
+/* NOTE: encoded Int16 RF data. data holds a single frame of sample_count samples in the
+ * given encoding; it is expanded back to Int16 by the beamformer's upload thread. Packed
+ * encodings store the low 12 or 14 bits of each sample; DeltaBlocks is lossless.
+ * beamformer_encode_rf() produces any of the encodings and returns the encoded size
+ * (0 on failure); beamformer_encoded_size_bound() gives the largest size it can produce.
+ * For RF slots acquire the slot with the encoded size and frame_count = 1, fill it, and call
+ * beamformer_rf_slot_set_encoding() before releasing it */
+LIB_FN uint64_t beamformer_encoded_size_bound(BeamformerRFEncoding encoding, uint32_t sample_count);
+LIB_FN uint32_t beamformer_encode_rf(int16_t *samples, uint32_t sample_count, BeamformerRFEncoding encoding,
+                                     void *out, uint32_t out_capacity);
+LIB_FN uint32_t beamformer_push_encoded_data_with_compute(void *data, uint32_t data_size, uint32_t sample_count,
+                                                          BeamformerRFEncoding encoding,
+                                                          uint32_t image_plane_tag, uint32_t parameter_slot);
+LIB_FN uint32_t beamformer_rf_slot_set_encoding(uint32_t slot_index, BeamformerRFEncoding encoding,
+                                                uint32_t sample_count);
+
 ///////////////////////////
 // Parameter Configuration
 LIB_FN uint32_t beamformer_reserve_parameter_blocks(uint32_t count);
+
+/* NOTE: stage parameters are interpreted per shader:
+ *   Filter/Demodulate: filter slot
+ *   Sum:               BeamformerSumMode (averaging window is output_points[3]) */
 LIB_FN uint32_t beamformer_set_pipeline_stage_parameters(uint32_t stage_index, int32_t parameter);
 LIB_FN uint32_t beamformer_push_pipeline(int32_t *shaders, uint32_t shader_count, BeamformerDataKind data_kind);
 
@@ -27,6 +27,7 @@
   #define unreachable() __assume(0)
 
   #define memory_write_barrier()       _WriteBarrier()
+  #define memory_read_barrier()        _ReadBarrier()
 
   #define atomic_store_u64(ptr, n)     *((volatile u64 *)(ptr)) = (n)
   #define atomic_store_u32(ptr, n)     *((volatile u32 *)(ptr)) = (n)
@@ -39,6 +40,8 @@
   #define atomic_cas_u64(ptr, cptr, n)  (_InterlockedCompareExchange64((volatile u64 *)(ptr), *(cptr), (n)) == *(cptr))
   #define atomic_cas_u32(ptr, cptr, n)  (_InterlockedCompareExchange((volatile u32 *)(ptr),   *(cptr), (n)) == *(cptr))
   #define atomic_or_u32(ptr, n)          _InterlockedOr((volatile u32 *)(ptr), (n))
+  #define atomic_swap_u32(ptr, n)        _InterlockedExchange((volatile u32 *)(ptr), (n))
+  #define atomic_swap_u64(ptr, n)        _InterlockedExchange64((volatile u64 *)(ptr), (n))
 
   #define atan2_f32(y, x) atan2f(y, x)
   #define cos_f32(a)      cosf(a)
@@ -64,6 +67,7 @@
   #define unreachable() __builtin_unreachable()
 
   #define memory_write_barrier()        asm volatile ("" ::: "memory")
+  #define memory_read_barrier()         __atomic_thread_fence(__ATOMIC_ACQUIRE)
 
   #define atomic_store_u64(ptr, n)      __atomic_store_n(ptr,    n, __ATOMIC_RELEASE)
   #define atomic_load_u64(ptr)          __atomic_load_n(ptr,        __ATOMIC_ACQUIRE)
@@ -71,11 +75,13 @@
   #define atomic_and_u64(ptr, n)        __atomic_and_fetch(ptr,  n, __ATOMIC_RELEASE)
   #define atomic_cas_u64(ptr, cptr, n)  __atomic_compare_exchange_n(ptr, cptr, n, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
   #define atomic_or_u32(ptr, n)         __atomic_or_fetch(ptr,   n, __ATOMIC_RELEASE)
+  #define atomic_swap_u64(ptr, n)       __atomic_exchange_n(ptr, n, __ATOMIC_ACQ_REL)
   #define atomic_add_u32                atomic_add_u64
   #define atomic_and_u32                atomic_and_u64
   #define atomic_cas_u32                atomic_cas_u64
   #define atomic_load_u32               atomic_load_u64
   #define atomic_store_u32              atomic_store_u64
+  #define atomic_swap_u32               atomic_swap_u64
 
   #define atan2_f32(y, x) __builtin_atan2f(y, x)
   #define cos_f32(a)      __builtin_cosf(a)
@@ -179,6 +185,14 @@ typedef int32x4_t   i32x4;
 #define store_i32x4(o, a)     vst1q_s32(o, a)
 #define sub_f32x4(a, b)       vsubq_f32(a, b)
 
+/* NOTE(rnp): NEON has no non-temporal store for q registers; order with a store barrier */
+#define stream_i32x4(o, a)    vst1q_s32(o, a)
+#if COMPILER_MSVC
+  #define store_fence()       __dmb(_ARM64_BARRIER_ISHST)
+#else
+  #define store_fence()       asm volatile ("dmb ishst" ::: "memory")
+#endif
+
 #elif ARCH_X64
 #include <immintrin.h>
 typedef __m128  f32x4;
@@ -201,4 +215,8 @@ typedef __m128i i32x4;
 #define store_i32x4(o, a)     _mm_storeu_si128((i32x4 *)o, a)
 #define sub_f32x4(a, b)       _mm_sub_ps(a, b)
 
+/* NOTE(rnp): destination must be 16 byte aligned */
+#define stream_i32x4(o, a)    _mm_stream_si128((i32x4 *)o, a)
+#define store_fence()         _mm_sfence()
+
 #endif
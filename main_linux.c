@@ -17,6 +17,8 @@
 
 #define OS_RENDERDOC_SONAME    "librenderdoc.so"
 
+#define OS_ZSTD_LIB_NAME       "libzstd.so.1"
+
 /* TODO(rnp): what do if not X11? */
 iptr glfwGetGLXContext(iptr);
 function iptr
@@ -71,15 +73,15 @@ dispatch_file_watch_events(OS *os, Arena arena)
 }
 
 extern i32
-main(void)
+main(i32 argc, char *argv[])
 {
 	Arena program_memory = os_alloc_arena(MB(16));
 
 	BeamformerCtx   *ctx   = 0;
 	BeamformerInput *input = 0;
 
-	setup_beamformer(&program_memory, &ctx, &input);
-	os_wake_waiters(&ctx->os.compute_worker.sync_variable);
+	setup_beamformer(&program_memory, &ctx, &input, argc, argv);
+	os_wake_waiters(&ctx->os.compute_workers[0].sync_variable);
 
 	struct pollfd fds[1] = {{0}};
 	fds[0].fd     = (i32)ctx->os.file_watch_context.handle;
@@ -17,6 +17,8 @@
 
 #define OS_RENDERDOC_SONAME    "renderdoc.dll"
 
+#define OS_ZSTD_LIB_NAME       "zstd.dll"
+
 iptr glfwGetWGLContext(iptr);
 function iptr
 os_get_native_gl_context(iptr window)
@@ -100,15 +102,15 @@ clear_io_queue(OS *os, BeamformerInput *input, Arena arena)
 }
 
 extern i32
-main(void)
+main(i32 argc, char *argv[])
 {
 	Arena program_memory = os_alloc_arena(MB(16));
 
 	BeamformerCtx   *ctx   = 0;
 	BeamformerInput *input = 0;
 
-	setup_beamformer(&program_memory, &ctx, &input);
-	os_wake_waiters(&ctx->os.compute_worker.sync_variable);
+	setup_beamformer(&program_memory, &ctx, &input, argc, argv);
+	os_wake_waiters(&ctx->os.compute_workers[0].sync_variable);
 
 	w32_context *w32_ctx = (w32_context *)ctx->os.context;
 	u64 last_time = os_get_timer_counter();
@@ -0,0 +1,132 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): splits large copies into chunks which are claimed by the caller and a small
+ * pool of helper threads. chunks are written with non-temporal stores since the destination
+ * (mapped GPU memory or shared memory) will not be read back by the copying thread */
+
+#define MEMORY_COPY_MAX_HELPERS       (8)
+#define MEMORY_COPY_CHUNK_SIZE        (MB(2))
+#define MEMORY_COPY_DEFAULT_HELPERS   (3)
+#define MEMORY_COPY_DEFAULT_THRESHOLD (MB(8))
+
+typedef struct MemoryCopyEngine MemoryCopyEngine;
+
+typedef struct {
+	MemoryCopyEngine *engine;
+	i32               sync_variable;
+} MemoryCopyHelper;
+
+struct MemoryCopyEngine {
+	MemoryCopyHelper helpers[MEMORY_COPY_MAX_HELPERS];
+	u32              helper_count;
+
+	/* NOTE(rnp): copies smaller than this are done on the calling thread */
+	u64 threshold;
+
+	/* NOTE(rnp): only one copy can be in flight; others fall back to the calling thread */
+	u32 lock;
+
+	u8 *dest;
+	u8 *src;
+	u64 size;
+	u64 chunk_count;
+	u64 next_chunk;
+	u64 finished_chunks;
+	u32 finished_helpers;
+};
+
+function void
+memory_copy_streaming(u8 *restrict dest, u8 *restrict src, uz n)
+{
+	#if ARCH_X64 || ARCH_ARM64
+	uz head = MIN(n, -(uintptr_t)dest & 15);
+	mem_copy(dest, src, head);
+	dest += head;
+	src  += head;
+	n    -= head;
+
+	for (; n >= 64; n -= 64, dest += 64, src += 64) {
+		i32x4 a = load_i32x4((i32 *)(src +  0));
+		i32x4 b = load_i32x4((i32 *)(src + 16));
+		i32x4 c = load_i32x4((i32 *)(src + 32));
+		i32x4 d = load_i32x4((i32 *)(src + 48));
+		stream_i32x4((i32 *)(dest +  0), a);
+		stream_i32x4((i32 *)(dest + 16), b);
+		stream_i32x4((i32 *)(dest + 32), c);
+		stream_i32x4((i32 *)(dest + 48), d);
+	}
+	#endif
+	mem_copy(dest, src, n);
+}
+
+function void
+memory_copy_engine_work(MemoryCopyEngine *e)
+{
+	for (;;) {
+		u64 chunk = atomic_add_u64(&e->next_chunk, 1);
+		if (chunk >= e->chunk_count)
+			break;
+		u64 offset = chunk * MEMORY_COPY_CHUNK_SIZE;
+		memory_copy_streaming(e->dest + offset, e->src + offset, (uz)MIN(MEMORY_COPY_CHUNK_SIZE, e->size - offset));
+		/* NOTE(rnp): non-temporal stores are weakly ordered */
+		store_fence();
+		atomic_add_u64(&e->finished_chunks, 1);
+	}
+}
+
+function OS_THREAD_ENTRY_POINT_FN(memory_copy_helper_entry_point)
+{
+	MemoryCopyHelper *h = (MemoryCopyHelper *)_ctx;
+	for (;;) {
+		i32 expected = 0;
+		if (atomic_cas_u32(&h->sync_variable, &expected, 1)) {
+			memory_copy_engine_work(h->engine);
+			atomic_add_u32(&h->engine->finished_helpers, 1);
+		} else {
+			os_wait_on_value(&h->sync_variable, 1, (u32)-1);
+		}
+	}
+
+	unreachable();
+
+	return 0;
+}
+
+function void
+memory_copy_engine_init(MemoryCopyEngine *e, u32 helper_count, u64 threshold)
+{
+	e->helper_count = MIN(helper_count, MEMORY_COPY_MAX_HELPERS);
+	e->threshold    = threshold;
+	for (u32 i = 0; i < e->helper_count; i++) {
+		e->helpers[i].engine        = e;
+		e->helpers[i].sync_variable = 1;
+	}
+}
+
+function void
+memory_copy(MemoryCopyEngine *e, void *restrict dest, void *restrict src, uz n)
+{
+	u32 unlocked = 0;
+	if (!e || e->helper_count == 0 || n < e->threshold || !atomic_cas_u32(&e->lock, &unlocked, 1)) {
+		mem_copy(dest, src, n);
+	} else {
+		e->dest             = dest;
+		e->src              = src;
+		e->size             = n;
+		e->chunk_count      = (n + MEMORY_COPY_CHUNK_SIZE - 1) / MEMORY_COPY_CHUNK_SIZE;
+		e->next_chunk       = 0;
+		e->finished_chunks  = 0;
+		e->finished_helpers = 0;
+		memory_write_barrier();
+
+		for (u32 i = 0; i < e->helper_count; i++)
+			os_wake_waiters(&e->helpers[i].sync_variable);
+		memory_copy_engine_work(e);
+
+		/* NOTE(rnp): helpers read the job description so all of them must be out before
+		 * the next copy can reuse it */
+		spin_wait(atomic_load_u64(&e->finished_chunks)  != e->chunk_count ||
+		          atomic_load_u32(&e->finished_helpers) != e->helper_count);
+		atomic_store_u32(&e->lock, 0);
+	}
+}
@@ -11,14 +11,21 @@
 #include <GL/gl.h>
 
 /* NOTE: do not add extra 0s to these, even at the start -> garbage compilers will complain */
+#define GL_SYNC_FLUSH_COMMANDS_BIT         0x00000001
+#define GL_MAP_READ_BIT                    0x0001
 #define GL_MAP_WRITE_BIT                   0x0002
 #define GL_MAP_FLUSH_EXPLICIT_BIT          0x0010
 #define GL_MAP_UNSYNCHRONIZED_BIT          0x0020
+#define GL_MAP_PERSISTENT_BIT              0x0040
+#define GL_MAP_COHERENT_BIT                0x0080
 #define GL_DYNAMIC_STORAGE_BIT             0x0100
+#define GL_CLIENT_STORAGE_BIT              0x0200
 #define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
 #define GL_TEXTURE_UPDATE_BARRIER_BIT      0x00000100
 #define GL_SHADER_STORAGE_BARRIER_BIT      0x00002000
+#define GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT 0x00004000
 
+#define GL_HALF_FLOAT                      0x140B
 #define GL_UNSIGNED_INT_8_8_8_8            0x8035
 #define GL_TEXTURE_3D                      0x806F
 #define GL_MAX_3D_TEXTURE_SIZE             0x8073
@@ -29,7 +36,9 @@
 #define GL_MAJOR_VERSION                   0x821B
 #define GL_MINOR_VERSION                   0x821C
 #define GL_RG                              0x8227
+#define GL_R16F                            0x822D
 #define GL_R32F                            0x822E
+#define GL_RG16F                           0x822F
 #define GL_RG32F                           0x8230
 #define GL_R8I                             0x8231
 #define GL_R16I                            0x8233
@@ -38,11 +47,14 @@
 #define GL_PROGRAM                         0x82E2
 #define GL_MIRRORED_REPEAT                 0x8370
 #define GL_QUERY_RESULT                    0x8866
+#define GL_QUERY_RESULT_AVAILABLE          0x8867
 #define GL_READ_ONLY                       0x88B8
 #define GL_WRITE_ONLY                      0x88B9
 #define GL_READ_WRITE                      0x88BA
+#define GL_TEXTURE_FREE_MEMORY_ATI         0x87FC
 #define GL_TIME_ELAPSED                    0x88BF
 #define GL_STATIC_DRAW                     0x88E4
+#define GL_PIXEL_PACK_BUFFER               0x88EB
 #define GL_UNIFORM_BUFFER                  0x8A11
 #define GL_MAX_UNIFORM_BLOCK_SIZE          0x8A30
 #define GL_FRAGMENT_SHADER                 0x8B30
@@ -57,6 +69,8 @@
 #define GL_RENDERBUFFER                    0x8D41
 #define GL_RED_INTEGER                     0x8D94
 #define GL_TIMESTAMP                       0x8E28
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
 #define GL_MIN_MAP_BUFFER_ALIGNMENT        0x90BC
 #define GL_SHADER_STORAGE_BUFFER           0x90D2
 #define GL_MAX_SHADER_STORAGE_BLOCK_SIZE   0x90DE
@@ -80,6 +94,7 @@ typedef struct __GLsync *GLsync;
 #define OGLProcedureList \
 	X(glAttachShader,                        void,   (GLuint program, GLuint shader)) \
 	X(glBeginQuery,                          void,   (GLenum target, GLuint id)) \
+	X(glBindBuffer,                          void,   (GLenum target, GLuint buffer)) \
 	X(glBindBufferBase,                      void,   (GLenum target, GLuint index, GLuint buffer)) \
 	X(glBindBufferRange,                     void,   (GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)) \
 	X(glBindFramebuffer,                     void,   (GLenum target, GLuint framebuffer)) \
@@ -115,6 +130,7 @@ typedef struct __GLsync *GLsync;
 	X(glGetProgramInfoLog,                   void,   (GLuint program, GLsizei maxLength, GLsizei *length, GLchar *infoLog)) \
 	X(glGetProgramiv,                        void,   (GLuint program, GLenum pname, GLint *params)) \
 	X(glGetQueryObjectui64v,                 void,   (GLuint id, GLenum pname, GLuint64 *params)) \
+	X(glGetQueryObjectuiv,                   void,   (GLuint id, GLenum pname, GLuint *params)) \
 	X(glGetShaderInfoLog,                    void,   (GLuint shader, GLsizei maxLength, GLsizei *length, GLchar *infoLog)) \
 	X(glGetShaderiv,                         void,   (GLuint shader, GLenum pname, GLint *params)) \
 	X(glGetTextureImage,                     void,   (GLuint texture, GLint level, GLenum format, GLenum type, GLsizei bufSize, void *pixels)) \
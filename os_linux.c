@@ -4,6 +4,9 @@
  * be provided by any platform the beamformer is ported to. */
 
 #define OS_SHARED_MEMORY_NAME "/ogl_beamformer_shared_memory"
+/* NOTE(rnp): shm_open() can't give huge pages; when they are requested the region is a file
+ * on hugetlbfs instead. only one of the two exists at a time */
+#define OS_HUGE_PAGES_PATH    "/dev/hugepages"
 
 #define OS_PATH_SEPARATOR_CHAR '/'
 #define OS_PATH_SEPARATOR      "/"
@@ -11,20 +14,29 @@
 #include "util.h"
 
 #include <dlfcn.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <linux/futex.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <poll.h>
 #include <pthread.h>
 #include <sys/inotify.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/vfs.h>
 #include <unistd.h>
 
 /* NOTE(rnp): hidden behind feature flags -> screw compiler/standards idiots */
 #ifndef CLOCK_MONOTONIC
   #define CLOCK_MONOTONIC 1
 #endif
+#ifndef MADV_POPULATE_WRITE
+  #define MADV_POPULATE_WRITE 23
+#endif
 i32 ftruncate(i32, i64);
 i64 syscall(i64, ...);
 i32 clock_gettime(i32, struct timespec *);
@@ -118,6 +130,25 @@ function OS_READ_WHOLE_FILE_FN(os_read_whole_file)
 	return result;
 }
 
+/* NOTE: read only mapping of a whole file; the kernel is asked to start reading it in */
+function s8
+os_map_file(char *path)
+{
+	s8 result = {0};
+	struct stat sb;
+	i32 fd = open(path, O_RDONLY);
+	if (fd >= 0 && fstat(fd, &sb) >= 0 && sb.st_size > 0) {
+		void *new = mmap(0, (uz)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (new != MAP_FAILED) {
+			madvise(new, (uz)sb.st_size, MADV_WILLNEED);
+			result.data = new;
+			result.len  = sb.st_size;
+		}
+	}
+	if (fd >= 0) close(fd);
+	return result;
+}
+
 function OS_WRITE_NEW_FILE_FN(os_write_new_file)
 {
 	b32 result = 0;
@@ -138,16 +169,63 @@ os_file_exists(char *path)
 }
 
 function SharedMemoryRegion
-os_create_shared_memory_area(Arena *arena, char *name, u32 lock_count, iz requested_capacity)
+os_create_shared_memory_area(Arena *arena, char *name, u32 lock_count, iz requested_capacity, u32 *flags)
 {
 	iz capacity = os_round_up_to_page_size(requested_capacity);
 	SharedMemoryRegion result = {0};
-	i32 fd = shm_open(name, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR);
-	if (fd > 0 && ftruncate(fd, capacity) != -1) {
-		void *new = mmap(0, (uz)capacity, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
-		if (new != MAP_FAILED) result.region = new;
+
+	Stream sb = arena_stream(*arena);
+	stream_append_s8s(&sb, s8(OS_HUGE_PAGES_PATH), c_str_to_s8(name));
+	stream_append_byte(&sb, 0);
+	char *huge_path = (char *)sb.data;
+
+	if (*flags & OSSharedMemoryFlags_HugePages) {
+		i32 fd = open(huge_path, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR);
+		struct statfs fs;
+		if (fd >= 0 && fstatfs(fd, &fs) == 0) {
+			iz huge_capacity = round_up_to(capacity, fs.f_bsize);
+			if (ftruncate(fd, huge_capacity) != -1) {
+				void *new = mmap(0, (uz)huge_capacity, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+				if (new != MAP_FAILED) {
+					result.region = new;
+					capacity      = huge_capacity;
+					shm_unlink(name);
+				}
+			}
+		}
+		if (fd >= 0) close(fd);
+		if (!result.region) unlink(huge_path);
+	}
+
+	if (!result.region) {
+		i32 fd = shm_open(name, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR);
+		if (fd > 0 && ftruncate(fd, capacity) != -1) {
+			void *new = mmap(0, (uz)capacity, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+			if (new != MAP_FAILED) result.region = new;
+		}
+		if (fd > 0) close(fd);
+
+		/* NOTE(rnp): fall back to transparent huge pages; only honoured if the system's
+		 * shmem_enabled setting allows it */
+		if (result.region && (*flags & OSSharedMemoryFlags_HugePages)) {
+			if (madvise(result.region, (uz)capacity, MADV_HUGEPAGE) != 0)
+				*flags &= ~(u32)OSSharedMemoryFlags_HugePages;
+			unlink(huge_path);
+		}
+	}
+
+	if (result.region && (*flags & OSSharedMemoryFlags_Prefault)) {
+		/* NOTE(rnp): older kernels don't have MADV_POPULATE_WRITE; touch every page instead */
+		if (madvise(result.region, (uz)capacity, MADV_POPULATE_WRITE) != 0) {
+			iz page_size = sysconf(_SC_PAGESIZE);
+			for (iz offset = 0; offset < capacity; offset += page_size)
+				((volatile u8 *)result.region)[offset] = 0;
+		}
 	}
-	if (fd > 0) close(fd);
+
+	if (result.region && (*flags & OSSharedMemoryFlags_Lock) && mlock(result.region, (uz)capacity) != 0)
+		*flags &= ~(u32)OSSharedMemoryFlags_Lock;
+
 	return result;
 }
 
@@ -265,11 +343,18 @@ function OS_WAIT_ON_VALUE_FN(os_wait_on_value)
 	return syscall(SYS_futex, value, FUTEX_WAIT, current, timeout, 0, 0) == 0;
 }
 
+/* NOTE: wakes everyone waiting on value without changing it */
+function void
+os_wake_all_waiters(i32 *value)
+{
+	syscall(SYS_futex, value, FUTEX_WAKE, I32_MAX, 0, 0, 0);
+}
+
 function OS_WAKE_WAITERS_FN(os_wake_waiters)
 {
 	if (sync) {
 		atomic_store_u32(sync, 0);
-		syscall(SYS_futex, sync, FUTEX_WAKE, I32_MAX, 0, 0, 0);
+		os_wake_all_waiters(sync);
 	}
 }
 
@@ -296,6 +381,111 @@ function OS_SHARED_MEMORY_UNLOCK_REGION_FN(os_shared_memory_region_unlock)
 	os_wake_waiters(lock);
 }
 
+/* NOTE(rnp): large socket buffers let RF frames stream without waiting on each ack */
+#define OS_SOCKET_BUFFER_SIZE MB(4)
+
+function void
+os_socket_configure(i32 fd, b32 tcp)
+{
+	i32 size = (i32)OS_SOCKET_BUFFER_SIZE, one = 1;
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	if (tcp) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+/* NOTE(rnp): returns a listening socket when listen is set otherwise a connected one */
+function iptr
+os_socket_open(char *address, b32 listen_socket)
+{
+	iptr result = INVALID_FILE;
+	SocketAddress sa;
+	if (parse_socket_address(c_str_to_s8(address), &sa)) {
+		union {
+			struct sockaddr    base;
+			struct sockaddr_in in;
+			struct sockaddr_un un;
+		} addr = {0};
+		socklen_t addr_size;
+		if (sa.path.len) {
+			addr.un.sun_family = AF_UNIX;
+			mem_copy(addr.un.sun_path, sa.path.data, (uz)MIN(sa.path.len, (iz)sizeof(addr.un.sun_path) - 1));
+			addr_size = sizeof(addr.un);
+		} else {
+			addr.in.sin_family = AF_INET;
+			mem_copy(&addr.in.sin_port, sa.port, sizeof(sa.port));
+			mem_copy(&addr.in.sin_addr, sa.ipv4, sizeof(sa.ipv4));
+			addr_size = sizeof(addr.in);
+		}
+
+		i32 fd = -1;
+		if (sa.path.len < (iz)sizeof(addr.un.sun_path))
+			fd = socket(addr.base.sa_family, SOCK_STREAM|SOCK_CLOEXEC, 0);
+		if (fd >= 0) {
+			b32 ok;
+			if (listen_socket) {
+				i32 one = 1;
+				if (sa.path.len) unlink(addr.un.sun_path);
+				else             setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+				ok = bind(fd, &addr.base, addr_size) == 0 && listen(fd, 1) == 0;
+			} else {
+				os_socket_configure(fd, sa.path.len == 0);
+				ok = connect(fd, &addr.base, addr_size) == 0;
+			}
+			if (ok) result = fd;
+			else    close(fd);
+		}
+	}
+	return result;
+}
+
+function iptr
+os_socket_accept(iptr listener)
+{
+	iptr result = INVALID_FILE;
+	struct sockaddr_storage addr;
+	socklen_t addr_size = sizeof(addr);
+	i32 fd = accept((i32)listener, (struct sockaddr *)&addr, &addr_size);
+	if (fd >= 0) {
+		os_socket_configure(fd, addr.ss_family == AF_INET);
+		result = fd;
+	}
+	return result;
+}
+
+function b32
+os_socket_send(iptr handle, void *data, u64 size)
+{
+	u8 *bytes = data;
+	while (size > 0) {
+		iz sent = send((i32)handle, bytes, (uz)size, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) break;
+		bytes += sent;
+		size  -= (u64)sent;
+	}
+	return size == 0;
+}
+
+function b32
+os_socket_receive(iptr handle, void *data, u64 size)
+{
+	u8 *bytes = data;
+	while (size > 0) {
+		iz received = recv((i32)handle, bytes, (uz)size, MSG_WAITALL);
+		if (received < 0 && errno == EINTR) continue;
+		if (received <= 0) break;
+		bytes += received;
+		size  -= (u64)received;
+	}
+	return size == 0;
+}
+
+function void
+os_socket_close(iptr handle)
+{
+	close((i32)handle);
+}
+
 function void
 os_init(OS *os, Arena *program_memory)
 {
@@ -11,7 +11,10 @@
 #define STD_OUTPUT_HANDLE -11
 #define STD_ERROR_HANDLE  -12
 
+#define PAGE_READONLY  0x02
 #define PAGE_READWRITE 0x04
+#define SEC_COMMIT      0x08000000
+#define SEC_LARGE_PAGES 0x80000000
 #define MEM_COMMIT     0x1000
 #define MEM_RESERVE    0x2000
 
@@ -19,7 +22,9 @@
 #define GENERIC_READ   0x80000000
 
 #define FILE_SHARE_READ            0x00000001
+#define FILE_MAP_READ              0x00000004
 #define FILE_MAP_ALL_ACCESS        0x000F001F
+#define FILE_MAP_LARGE_PAGES       0x20000000
 #define FILE_FLAG_BACKUP_SEMANTICS 0x02000000
 #define FILE_FLAG_OVERLAPPED       0x40000000
 
@@ -32,6 +37,16 @@
 
 #define THREAD_SET_LIMITED_INFORMATION 0x0400
 
+#define AF_UNIX      1
+#define AF_INET      2
+#define SOCK_STREAM  1
+#define SOL_SOCKET   0xFFFF
+#define SO_SNDBUF    0x1001
+#define SO_RCVBUF    0x1002
+#define IPPROTO_TCP  6
+#define TCP_NODELAY  1
+#define MSG_WAITALL  0x8
+
 /* NOTE: this is packed because the w32 api designers are dumb and ordered the members
  * incorrectly. They worked around it be making the ft* members a struct {u32, u32} which
  * is aligned on a 4-byte boundary. Then in their documentation they explicitly tell you not
@@ -86,6 +101,18 @@ typedef struct {
 	u32   reserved_count;
 } w32_shared_memory_context;
 
+typedef struct {
+	u16 family;
+	u8  port[2];
+	u8  addr[4];
+	u8  zero[8];
+} w32_sockaddr_in;
+
+typedef struct {
+	u16 family;
+	c8  path[108];
+} w32_sockaddr_un;
+
 #define W32(r) __declspec(dllimport) r __stdcall
 W32(b32)    CloseHandle(iptr);
 W32(b32)    CopyFileA(c8 *, c8 *, b32);
@@ -104,6 +131,7 @@ W32(void *) GetModuleHandleA(c8 *);
 W32(void *) GetProcAddress(void *, c8 *);
 W32(b32)    GetQueuedCompletionStatus(iptr, u32 *, uptr *, w32_overlapped **, u32);
 W32(iptr)   GetStdHandle(i32);
+W32(uz)     GetLargePageMinimum(void);
 W32(void)   GetSystemInfo(void *);
 W32(void *) LoadLibraryA(c8 *);
 W32(void *) MapViewOfFile(iptr, u32, u32, u32, u64);
@@ -119,6 +147,19 @@ W32(i32)    WakeByAddressAll(void *);
 W32(iptr)   wglGetProcAddress(c8 *);
 W32(b32)    WriteFile(iptr, u8 *, i32, i32 *, void *);
 W32(void *) VirtualAlloc(u8 *, iz, u32, u32);
+W32(b32)    VirtualLock(void *, uz);
+
+/* NOTE: ws2_32 */
+W32(iptr)   accept(iptr, void *, i32 *);
+W32(i32)    bind(iptr, void *, i32);
+W32(i32)    closesocket(iptr);
+W32(i32)    connect(iptr, void *, i32);
+W32(i32)    listen(iptr, i32);
+W32(i32)    recv(iptr, u8 *, i32, i32);
+W32(i32)    send(iptr, u8 *, i32, i32);
+W32(i32)    setsockopt(iptr, i32, i32, void *, i32);
+W32(iptr)   socket(i32, i32, i32);
+W32(i32)    WSAStartup(u16, void *);
 
 #ifdef _DEBUG
 function void *
@@ -226,6 +267,27 @@ function OS_READ_WHOLE_FILE_FN(os_read_whole_file)
 	return result;
 }
 
+/* NOTE: read only mapping of a whole file */
+function s8
+os_map_file(char *path)
+{
+	s8 result = {0};
+	w32_file_info fileinfo;
+	iptr h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+	if (h >= 0 && GetFileInformationByHandle(h, &fileinfo)) {
+		iz filesize  = (iz)fileinfo.nFileSizeHigh << 32;
+		filesize    |= (iz)fileinfo.nFileSizeLow;
+		iptr mapping = CreateFileMappingA(h, 0, PAGE_READONLY, 0, 0, 0);
+		if (mapping != INVALID_FILE && mapping) {
+			result.data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (result.data) result.len = filesize;
+			CloseHandle(mapping);
+		}
+	}
+	if (h >= 0) CloseHandle(h);
+	return result;
+}
+
 function OS_WRITE_NEW_FILE_FN(os_write_new_file)
 {
 	b32 result = 0;
@@ -251,15 +313,38 @@ os_file_exists(char *path)
 }
 
 function SharedMemoryRegion
-os_create_shared_memory_area(Arena *arena, char *name, u32 lock_count, iz requested_capacity)
+os_create_shared_memory_area(Arena *arena, char *name, u32 lock_count, iz requested_capacity, u32 *flags)
 {
 	iz capacity = os_round_up_to_page_size(requested_capacity);
-	assert(capacity <= (iz)U32_MAX);
 	SharedMemoryRegion result = {0};
-	iptr h = CreateFileMappingA(-1, 0, PAGE_READWRITE, 0, (u32)capacity, name);
+
+	/* NOTE(rnp): large pages need SeLockMemoryPrivilege; without it fall back to normal pages */
+	iptr h = INVALID_FILE;
+	uz large_page_size = GetLargePageMinimum();
+	if ((*flags & OSSharedMemoryFlags_HugePages) && large_page_size) {
+		iz large_capacity = round_up_to(capacity, (iz)large_page_size);
+		h = CreateFileMappingA(-1, 0, PAGE_READWRITE|SEC_COMMIT|SEC_LARGE_PAGES,
+		                       (u32)((u64)large_capacity >> 32), (u32)large_capacity, name);
+		if (h != INVALID_FILE) capacity = large_capacity;
+	}
+	if (h == INVALID_FILE) {
+		*flags &= ~(u32)OSSharedMemoryFlags_HugePages;
+		h = CreateFileMappingA(-1, 0, PAGE_READWRITE, (u32)((u64)capacity >> 32), (u32)capacity, name);
+	}
+
 	if (h != INVALID_FILE) {
-		void *new = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, (u32)capacity);
+		u32 access = FILE_MAP_ALL_ACCESS;
+		if (*flags & OSSharedMemoryFlags_HugePages) access |= FILE_MAP_LARGE_PAGES;
+		void *new = MapViewOfFile(h, access, 0, 0, (u64)capacity);
 		if (new) {
+			if (*flags & OSSharedMemoryFlags_Prefault) {
+				for (iz offset = 0; offset < capacity; offset += KB(4))
+					((volatile u8 *)new)[offset] = 0;
+			}
+			/* NOTE(rnp): limited by the working set size; treated as a hint */
+			if ((*flags & OSSharedMemoryFlags_Lock) && !VirtualLock(new, (uz)capacity))
+				*flags &= ~(u32)OSSharedMemoryFlags_Lock;
+
 			w32_shared_memory_context *ctx = push_struct(arena, typeof(*ctx));
 			ctx->semaphores     = push_array(arena, typeof(*ctx->semaphores), lock_count);
 			ctx->reserved_count = lock_count;
@@ -387,11 +472,19 @@ function OS_WAIT_ON_VALUE_FN(os_wait_on_value)
 	return WaitOnAddress(value, &current, sizeof(*value), timeout_ms);
 }
 
+/* NOTE: wakes everyone waiting on value without changing it. only reaches
+ * waiters in this process */
+function void
+os_wake_all_waiters(i32 *value)
+{
+	WakeByAddressAll(value);
+}
+
 function OS_WAKE_WAITERS_FN(os_wake_waiters)
 {
 	if (sync) {
 		atomic_store_u32(sync, 0);
-		WakeByAddressAll(sync);
+		os_wake_all_waiters(sync);
 	}
 }
 
@@ -411,6 +504,111 @@ function OS_SHARED_MEMORY_UNLOCK_REGION_FN(os_shared_memory_region_unlock)
 	ReleaseSemaphore(ctx->semaphores[lock_index], 1, 0);
 }
 
+/* NOTE(rnp): large socket buffers let RF frames stream without waiting on each ack */
+#define OS_SOCKET_BUFFER_SIZE MB(4)
+
+function void
+os_socket_configure(iptr s, b32 tcp)
+{
+	i32 size = (i32)OS_SOCKET_BUFFER_SIZE, one = 1;
+	setsockopt(s, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	setsockopt(s, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	if (tcp) setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+/* NOTE(rnp): returns a listening socket when listen is set otherwise a connected one.
+ * unix domain sockets need windows 10 1803 or newer */
+function iptr
+os_socket_open(char *address, b32 listen_socket)
+{
+	local_persist b32 winsock_started;
+	if (!winsock_started) {
+		u8 wsa_data[512];
+		winsock_started = WSAStartup(0x0202, wsa_data) == 0;
+	}
+
+	iptr result = INVALID_FILE;
+	SocketAddress sa;
+	if (winsock_started && parse_socket_address(c_str_to_s8(address), &sa)) {
+		union {
+			u16             family;
+			w32_sockaddr_in in;
+			w32_sockaddr_un un;
+		} addr = {0};
+		i32 addr_size;
+		if (sa.path.len) {
+			addr.un.family = AF_UNIX;
+			mem_copy(addr.un.path, sa.path.data, (uz)MIN(sa.path.len, (iz)sizeof(addr.un.path) - 1));
+			addr_size = sizeof(addr.un);
+		} else {
+			addr.in.family = AF_INET;
+			mem_copy(addr.in.port, sa.port, sizeof(sa.port));
+			mem_copy(addr.in.addr, sa.ipv4, sizeof(sa.ipv4));
+			addr_size = sizeof(addr.in);
+		}
+
+		iptr s = INVALID_FILE;
+		if (sa.path.len < (iz)sizeof(addr.un.path))
+			s = socket(addr.family, SOCK_STREAM, 0);
+		if (s != INVALID_FILE) {
+			b32 ok;
+			if (listen_socket) {
+				if (sa.path.len) DeleteFileA(addr.un.path);
+				ok = bind(s, &addr, addr_size) == 0 && listen(s, 1) == 0;
+			} else {
+				os_socket_configure(s, sa.path.len == 0);
+				ok = connect(s, &addr, addr_size) == 0;
+			}
+			if (ok) result = s;
+			else    closesocket(s);
+		}
+	}
+	return result;
+}
+
+function iptr
+os_socket_accept(iptr listener)
+{
+	u8  addr[128];
+	i32 addr_size = sizeof(addr);
+	iptr result = accept(listener, addr, &addr_size);
+	if (result != INVALID_FILE)
+		os_socket_configure(result, ((w32_sockaddr_in *)addr)->family == AF_INET);
+	return result;
+}
+
+function b32
+os_socket_send(iptr handle, void *data, u64 size)
+{
+	u8 *bytes = data;
+	while (size > 0) {
+		i32 sent = send(handle, bytes, (i32)MIN(size, GB(1)), 0);
+		if (sent <= 0) break;
+		bytes += sent;
+		size  -= (u64)sent;
+	}
+	return size == 0;
+}
+
+function b32
+os_socket_receive(iptr handle, void *data, u64 size)
+{
+	u8 *bytes = data;
+	while (size > 0) {
+		i32 received = recv(handle, bytes, (i32)MIN(size, GB(1)), MSG_WAITALL);
+		if (received <= 0) break;
+		bytes += received;
+		size  -= (u64)received;
+	}
+	return size == 0;
+}
+
+function void
+os_socket_close(iptr handle)
+{
+	closesocket(handle);
+}
+
 function void
 os_init(OS *os, Arena *program_memory)
 {
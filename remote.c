@@ -0,0 +1,355 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): serves clients which connect over a socket (protocol in beamformer_remote.c)
+ * instead of mapping the shared memory. one client is served at a time on its own thread.
+ * each message is applied to shared memory exactly as the library would have done it
+ * locally. RF payloads are received straight into an RF slot so remote frames take the same
+ * path to the GPU as frames written by local clients */
+
+typedef struct {
+	SharedMemoryRegion     *shared_memory;
+	BeamformerSharedMemory *sm;
+	i32                    *upload_worker_sync;
+	i32                    *compute_worker_sync;
+
+	iptr listener;
+	iptr client;
+	b32  disconnected;
+	u32  failed;
+	i32  wait_variable;
+} BeamformerRemote;
+
+function b32
+beamformer_remote_receive(BeamformerRemote *r, void *out, u64 size)
+{
+	b32 result = !r->disconnected && os_socket_receive(r->client, out, size);
+	r->disconnected |= !result;
+	return result;
+}
+
+/* NOTE(rnp): no valid message carries more than an RF slot's worth of payload; a client
+ * claiming more can't be trusted to be in sync with us so it is dropped instead */
+function void
+beamformer_remote_skip_payload(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	r->disconnected |= header->payload_size > BEAMFORMER_RF_SLOT_SIZE;
+	r->disconnected |= !r->disconnected && !beamformer_remote_discard(r->client, header->payload_size);
+}
+
+/* NOTE(rnp): receives a payload of exactly size bytes. anything else is thrown away */
+function b32
+beamformer_remote_receive_payload(BeamformerRemote *r, BeamformerRemoteHeader *header, void *out, u64 size)
+{
+	b32 result = 0;
+	if (header->payload_size == size) result = beamformer_remote_receive(r, out, size);
+	else                              beamformer_remote_skip_payload(r, header);
+	return result;
+}
+
+function void
+beamformer_remote_reply(BeamformerRemote *r, u32 kind, b32 success, void *payload, u64 payload_size)
+{
+	BeamformerRemoteHeader header = {
+		.kind         = kind,
+		.arguments    = {success},
+		.failed       = r->failed,
+		.payload_size = payload_size,
+	};
+	r->failed        = 0;
+	r->disconnected |= !beamformer_remote_send(r->client, &header, payload);
+}
+
+function BeamformWork *
+beamformer_remote_push_work(BeamformerRemote *r, BeamformWorkPayload **payload)
+{
+	BeamformWorkQueue *q = &r->sm->external_work_queue;
+	BeamformWork *result;
+	for (;;) {
+		if (payload) result = beamform_work_queue_push_with_payload(q, payload);
+		else         result = beamform_work_queue_push(q);
+		if (result) break;
+		os_wait_on_value(&r->wait_variable, 0, 1);
+	}
+	return result;
+}
+
+function b32
+beamformer_remote_parameter_upload(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	u32 block  = header->arguments[0];
+	u32 region = header->arguments[1];
+	u64 offset = header->arguments[2];
+
+	/* NOTE(rnp): only the named region is published so the upload must stay inside it */
+	b32 result = block < r->sm->reserved_parameter_blocks && region < BeamformerParameterBlockRegion_Count;
+	if (result) {
+		u64 region_offset = BeamformerParameterBlockRegionOffsets[region];
+		u64 region_size   = BeamformerParameterBlockRegionSizes[region];
+		result = offset >= region_offset && header->payload_size <= region_size &&
+		         offset - region_offset <= region_size - header->payload_size;
+	}
+	if (result) {
+		BeamformerParameterBlock *pb = beamformer_parameter_block_lock(r->shared_memory, block, -1);
+		result = beamformer_remote_receive(r, (u8 *)pb + offset, header->payload_size);
+		if (result) publish_parameter_block_region(r->sm, block, region);
+		beamformer_parameter_block_unlock(r->shared_memory, block);
+	} else {
+		beamformer_remote_skip_payload(r, header);
+	}
+	return result;
+}
+
+function b32
+beamformer_remote_pipeline(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	u32 block        = header->arguments[0];
+	u32 shader_count = 0;
+
+	i32 shaders[BeamformerMaxComputeShaderStages];
+	b32 result = header->payload_size <= sizeof(shaders);
+	if (result) {
+		shader_count = (u32)(header->payload_size / sizeof(i32));
+		result = beamformer_remote_receive_payload(r, header, shaders, shader_count * sizeof(i32));
+	} else {
+		beamformer_remote_skip_payload(r, header);
+	}
+	result = result && block < r->sm->reserved_parameter_blocks && header->arguments[1] < BeamformerDataKind_Count &&
+	         beamformer_check_pipeline(shaders, shader_count, header->arguments[1]) == BeamformerPipelineCheck_Valid;
+
+	if (result) {
+		BeamformerParameterBlock *pb = beamformer_parameter_block_lock(r->shared_memory, block, -1);
+		mem_copy(pb->pipeline.shaders, shaders, shader_count * sizeof(*shaders));
+		pb->pipeline.shader_count = shader_count;
+		pb->pipeline.data_kind    = header->arguments[1];
+		publish_parameter_block_region(r->sm, block, BeamformerParameterBlockRegion_ComputePipeline);
+		beamformer_parameter_block_unlock(r->shared_memory, block);
+	}
+	return result;
+}
+
+function b32
+beamformer_remote_create_filter(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	BeamformerFilterParameters parameters;
+	b32 result = beamformer_remote_receive_payload(r, header, &parameters, sizeof(parameters)) &&
+	             header->arguments[0] < BeamformerFilterKind_Count;
+	if (result) {
+		BeamformWorkPayload *payload;
+		BeamformWork *work = beamformer_remote_push_work(r, &payload);
+		work->kind = BeamformerWorkKind_CreateFilter;
+		work->create_filter_context.kind            = header->arguments[0];
+		work->create_filter_context.filter_slot     = (u8)(header->arguments[1] % BeamformerFilterSlots);
+		work->create_filter_context.parameter_block = (u8)(header->arguments[2] % BeamformerMaxParameterBlockSlots);
+		payload->filter_parameters = parameters;
+		beamform_work_queue_push_commit(&r->sm->external_work_queue, work);
+	}
+	return result;
+}
+
+function b32
+beamformer_remote_compute_indirect(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	b32 result = header->arguments[0] < BeamformerViewPlaneTag_Count &&
+	             header->arguments[1] < r->sm->reserved_parameter_blocks;
+	if (result) {
+		BeamformWork *work = beamformer_remote_push_work(r, 0);
+		work->kind = BeamformerWorkKind_ComputeIndirect;
+		work->compute_indirect_context.view_plane      = header->arguments[0];
+		work->compute_indirect_context.parameter_block = header->arguments[1];
+		beamform_work_queue_push_commit(&r->sm->external_work_queue, work);
+		os_wake_waiters(r->compute_worker_sync);
+	}
+	return result;
+}
+
+function b32
+beamformer_remote_rf_data(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	BeamformerSharedMemory *sm = r->sm;
+	u32 frame_size   = header->arguments[0];
+	u32 frame_count  = header->arguments[1];
+	u32 encoding     = header->arguments[2];
+	u32 sample_count = header->arguments[3];
+
+	/* NOTE(rnp): the upload reads each frame rounded up to 64 bytes. payload_size comes
+	 * straight off the wire so it is bounded before any arithmetic is done with it */
+	b32 result = frame_count > 0 && header->payload_size <= BEAMFORMER_RF_SLOT_SIZE - 64;
+	if (encoding == BeamformerRFEncoding_None) {
+		result &= header->payload_size == (u64)frame_size * frame_count;
+	} else {
+		result &= encoding < BeamformerRFEncoding_Count && frame_count == 1 &&
+		          header->payload_size <= U32_MAX &&
+		          sample_count > 0 && (u64)sample_count * sizeof(i16) <= U32_MAX;
+	}
+
+	if (result) {
+		i32 slot;
+		while ((slot = beamformer_rf_slot_try_acquire(sm, frame_size, frame_count)) < 0)
+			beamformer_rf_slot_wait(sm, 1);
+
+		if (encoding != BeamformerRFEncoding_None) {
+			sm->rf_slots[slot].encoding     = encoding;
+			sm->rf_slots[slot].encoded_size = (u32)header->payload_size;
+			sm->rf_slots[slot].frame_size   = sample_count * (u32)sizeof(i16);
+		}
+
+		/* NOTE(rnp): a client which goes away midway leaves a partial frame behind. the slot
+		 * is still handed over since later slots can't be uploaded until this one is */
+		result = beamformer_remote_receive(r, beamformer_rf_slot_data(sm, (u32)slot), header->payload_size);
+
+		atomic_store_u32(&sm->rf_slots[slot].state, BeamformerRFSlotState_Ready);
+		os_wake_waiters(r->upload_worker_sync);
+	} else {
+		beamformer_remote_skip_payload(r, header);
+	}
+	return result;
+}
+
+function b32
+beamformer_remote_export(BeamformerRemote *r, BeamformerRemoteHeader *header)
+{
+	BeamformerSharedMemory *sm = r->sm;
+	SharedMemoryRegion     *shared_memory = r->shared_memory;
+
+	u32 size       = header->arguments[1];
+	u32 timeout_ms = header->arguments[2];
+	Arena scratch  = beamformer_shared_memory_scratch_arena(sm);
+
+	b32 result = header->arguments[0] <= BeamformerExportKind_Stats && (iz)size <= arena_capacity(&scratch, u8) &&
+	             os_shared_memory_region_lock(shared_memory, sm->locks, BeamformerSharedMemoryLockKind_ExportSync,
+	                                          timeout_ms);
+	if (result) {
+		sm->export_buffer_options = sm->export_options;
+		BeamformWork *work = beamformer_remote_push_work(r, 0);
+		work->kind = BeamformerWorkKind_ExportBuffer;
+		work->lock = BeamformerSharedMemoryLockKind_ScratchSpace;
+		work->export_context.kind = header->arguments[0];
+		work->export_context.size = size;
+		beamform_work_queue_push_commit(&sm->external_work_queue, work);
+		os_wake_waiters(r->compute_worker_sync);
+
+		/* NOTE(rnp): the beamformer releases ExportSync once the data is in scratch */
+		result = os_shared_memory_region_lock(shared_memory, sm->locks, BeamformerSharedMemoryLockKind_ExportSync,
+		                                      timeout_ms);
+		if (result) {
+			result = os_shared_memory_region_lock(shared_memory, sm->locks, BeamformerSharedMemoryLockKind_ScratchSpace,
+			                                      0);
+			if (result) {
+				beamformer_remote_reply(r, header->kind, 1, scratch.beg, size);
+				os_shared_memory_region_unlock(shared_memory, sm->locks, BeamformerSharedMemoryLockKind_ScratchSpace);
+			}
+			os_shared_memory_region_unlock(shared_memory, sm->locks, BeamformerSharedMemoryLockKind_ExportSync);
+		}
+	}
+	if (!result) beamformer_remote_reply(r, header->kind, 0, 0, 0);
+	return result;
+}
+
+function void
+beamformer_remote_serve(BeamformerRemote *r)
+{
+	BeamformerSharedMemory *sm = r->sm;
+	BeamformerRemoteHeader header;
+	if (beamformer_remote_receive(r, &header, sizeof(header))) {
+		b32 result = 1;
+		switch (header.kind) {
+		case BeamformerRemoteMessageKind_Hello:{
+			beamformer_remote_receive_payload(r, &header, 0, 0);
+			b32 match = header.arguments[0] == BEAMFORMER_SHARED_MEMORY_VERSION;
+			beamformer_remote_reply(r, header.kind, match, 0, 0);
+			r->disconnected |= !match;
+		}break;
+		case BeamformerRemoteMessageKind_ReserveParameterBlocks:{
+			u32 count = header.arguments[0];
+			result = beamformer_remote_receive_payload(r, &header, 0, 0) &&
+			         BETWEEN(count, 1, BeamformerMaxParameterBlockSlots);
+			if (result) {
+				for (u32 i = sm->reserved_parameter_blocks; i < count; i++)
+					reset_parameter_block(sm, i);
+				sm->reserved_parameter_blocks = count;
+			}
+		}break;
+		case BeamformerRemoteMessageKind_ParameterUpload:{
+			result = beamformer_remote_parameter_upload(r, &header);
+		}break;
+		case BeamformerRemoteMessageKind_Pipeline:{
+			result = beamformer_remote_pipeline(r, &header);
+		}break;
+		case BeamformerRemoteMessageKind_CreateFilter:{
+			result = beamformer_remote_create_filter(r, &header);
+		}break;
+		case BeamformerRemoteMessageKind_ComputeIndirect:{
+			result = beamformer_remote_receive_payload(r, &header, 0, 0) &&
+			         beamformer_remote_compute_indirect(r, &header);
+		}break;
+		case BeamformerRemoteMessageKind_RFData:{
+			result = beamformer_remote_rf_data(r, &header);
+		}break;
+		case BeamformerRemoteMessageKind_LiveParameters:{
+			BeamformerLiveImagingParameters live;
+			result = beamformer_remote_receive_payload(r, &header, &live, sizeof(live));
+			if (result) {
+				mem_copy(&sm->live_imaging_parameters, &live, sizeof(live));
+				memory_write_barrier();
+			}
+		}break;
+		case BeamformerRemoteMessageKind_ExportOptions:{
+			BeamformerExportOptions options;
+			result = beamformer_remote_receive_payload(r, &header, &options, sizeof(options)) &&
+			         options.processing < BeamformerExportProcessing_Count;
+			if (result) {
+				sm->export_options = options;
+				memory_write_barrier();
+			}
+		}break;
+		case BeamformerRemoteMessageKind_Export:{
+			beamformer_remote_receive_payload(r, &header, 0, 0);
+			beamformer_remote_export(r, &header);
+		}break;
+		default:{
+			/* NOTE(rnp): the stream can't be trusted after an unknown message */
+			r->disconnected = 1;
+		}break;
+		}
+		if (!result) r->failed++;
+	}
+}
+
+function OS_THREAD_ENTRY_POINT_FN(beamformer_remote_entry_point)
+{
+	BeamformerRemote *r = (BeamformerRemote *)_ctx;
+	for (;;) {
+		r->client = os_socket_accept(r->listener);
+		if (r->client != INVALID_FILE) {
+			r->disconnected = 0;
+			r->failed       = 0;
+			while (!r->disconnected)
+				beamformer_remote_serve(r);
+			os_socket_close(r->client);
+		}
+	}
+
+	unreachable();
+
+	return 0;
+}
+
+function void
+beamformer_remote_start(BeamformerCtx *ctx, BeamformerOptions *options, Arena *memory)
+{
+	BeamformerRemote *r = push_struct(memory, BeamformerRemote);
+	r->shared_memory       = &ctx->shared_memory;
+	r->sm                  = ctx->shared_memory.region;
+	r->upload_worker_sync  = &ctx->os.upload_worker.sync_variable;
+	r->compute_worker_sync = &ctx->os.compute_workers[0].sync_variable;
+
+	r->listener = os_socket_open(options->listen_address, 1);
+	if (r->listener == INVALID_FILE) {
+		Stream err = arena_stream(*memory);
+		stream_append_s8s(&err, s8("remote: failed to listen on: "), c_str_to_s8(options->listen_address),
+		                  s8("\n"));
+		os_fatal(stream_to_s8(&err));
+	}
+
+	os_create_thread(*memory, (iptr)r, s8("[remote]"), beamformer_remote_entry_point);
+}
@@ -0,0 +1,315 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): streams a recorded study (the same layout consumed by tests/throughput.c)
+ * straight into the shared memory RF slots. the frame files are memory mapped and a small
+ * pool of workers decompresses them ahead of time. workers take turns, in file order,
+ * moving their decompressed frames into RF slots so that the beamformer sees the study in
+ * order no matter which worker finished first */
+
+#define BEAMFORMER_REPLAY_WORKERS (3)
+#define BEAMFORMER_REPLAY_MAGIC   (0x5042504D455AFECAULL)
+
+#define ZstdProcedureList \
+	X(u64, ZSTD_getFrameContentSize, (void *src, uz src_size))                     \
+	X(uz,  ZSTD_decompress,          (void *dst, uz capacity, void *src, uz size)) \
+	X(u32, ZSTD_isError,             (uz code))
+
+#define X(ret, name, params) typedef ret name##_fn params;
+ZstdProcedureList
+#undef X
+
+typedef struct {
+	u64 magic;
+	u32 version;
+	u16 decode_mode;
+	u16 beamform_mode;
+	u32 raw_data_dim[4];
+	u32 decoded_data_dim[4];
+	f32 xdc_element_pitch[2];
+	f32 xdc_transform[16]; /* NOTE: column major order */
+	i16 channel_mapping[256];
+	f32 transmit_angles[256];
+	f32 focal_depths[256];
+	i16 sparse_elements[256];
+	i16 hadamard_rows[256];
+	f32 speed_of_sound;
+	f32 center_frequency;
+	f32 sampling_frequency;
+	f32 time_offset;
+	i32 transmit_mode;
+} BeamformerReplayParametersV1;
+
+typedef struct BeamformerReplay BeamformerReplay;
+
+typedef struct {
+	BeamformerReplay *replay;
+	u8               *frames;
+	u32               index;
+	/* NOTE(rnp): 0 when it is this worker's turn to hand its frames to the beamformer */
+	i32               sync_variable;
+} BeamformerReplayWorker;
+
+struct BeamformerReplay {
+	BeamformerReplayWorker workers[BEAMFORMER_REPLAY_WORKERS];
+
+	s8  *files;
+	u32  file_count;
+	u32  frame_size;
+	u32  frames_per_file;
+	u32  frames_per_slot;
+
+	/* NOTE(rnp): 0 replays as fast as the beamformer accepts frames */
+	u64 frame_period;
+	u64 next_frame_time;
+	i32 pace_variable;
+
+	BeamformerSharedMemory *shared_memory;
+	MemoryCopyEngine       *copy_engine;
+	i32                    *upload_worker_sync;
+	i32                    *compute_worker_sync;
+
+	#define X(ret, name, params) name##_fn *name;
+	ZstdProcedureList
+	#undef X
+};
+
+function void
+beamformer_replay_pace(BeamformerReplay *r, u32 frame_count)
+{
+	if (r->frame_period) {
+		u64 now = os_get_timer_counter();
+		/* NOTE(rnp): don't try to catch up after a stall; that would just burst frames */
+		if (r->next_frame_time < now) r->next_frame_time = now;
+		while (now < r->next_frame_time) {
+			u64 ms = (r->next_frame_time - now) * 1000 / os_get_timer_frequency();
+			if (ms > 0) os_wait_on_value(&r->pace_variable, 0, (u32)ms);
+			now = os_get_timer_counter();
+		}
+		r->next_frame_time += r->frame_period * frame_count;
+	}
+}
+
+function void
+beamformer_replay_push_compute(BeamformerReplay *r)
+{
+	BeamformWorkQueue *q = &r->shared_memory->external_work_queue;
+	BeamformWork *work;
+	while (!(work = beamform_work_queue_push(q)))
+		os_wait_on_value(&r->pace_variable, 0, 1);
+	work->kind = BeamformerWorkKind_ComputeIndirect;
+	work->compute_indirect_context.view_plane      = BeamformerViewPlaneTag_XZ;
+	work->compute_indirect_context.parameter_block = 0;
+	beamform_work_queue_push_commit(q, work);
+}
+
+function void
+beamformer_replay_submit(BeamformerReplay *r, u8 *frames)
+{
+	BeamformerSharedMemory *sm = r->shared_memory;
+	for (u32 frame = 0; frame < r->frames_per_file; frame += r->frames_per_slot) {
+		u32 frame_count = MIN(r->frames_per_slot, r->frames_per_file - frame);
+
+		i32 slot;
+		while ((slot = beamformer_rf_slot_try_acquire(sm, r->frame_size, frame_count)) < 0)
+			beamformer_rf_slot_wait(sm, 1);
+
+		memory_copy(r->copy_engine, beamformer_rf_slot_data(sm, (u32)slot),
+		            frames + (uz)frame * r->frame_size, (uz)frame_count * r->frame_size);
+
+		beamformer_replay_pace(r, frame_count);
+
+		/* NOTE(rnp): the slot must be ready before its compute can be popped */
+		atomic_store_u32(&sm->rf_slots[slot].state, BeamformerRFSlotState_Ready);
+		os_wake_waiters(r->upload_worker_sync);
+		beamformer_replay_push_compute(r);
+		os_wake_waiters(r->compute_worker_sync);
+	}
+}
+
+function OS_THREAD_ENTRY_POINT_FN(beamformer_replay_worker_entry_point)
+{
+	BeamformerReplayWorker *w = (BeamformerReplayWorker *)_ctx;
+	BeamformerReplay       *r = w->replay;
+
+	uz size = (uz)r->frames_per_file * r->frame_size;
+	for (u32 file = w->index;; file += BEAMFORMER_REPLAY_WORKERS) {
+		s8 compressed = r->files[file % r->file_count];
+		uz decompressed = r->ZSTD_decompress(w->frames, size, compressed.data, (uz)compressed.len);
+		b32 valid = !r->ZSTD_isError(decompressed) && decompressed == size;
+
+		for (;;) {
+			i32 expected = 0;
+			if (atomic_cas_u32(&w->sync_variable, &expected, 1))
+				break;
+			os_wait_on_value(&w->sync_variable, 1, (u32)-1);
+		}
+
+		/* NOTE(rnp): a damaged file is skipped but still passes the turn along */
+		if (valid) beamformer_replay_submit(r, w->frames);
+
+		os_wake_waiters(&r->workers[(w->index + 1) % BEAMFORMER_REPLAY_WORKERS].sync_variable);
+	}
+
+	unreachable();
+
+	return 0;
+}
+
+function void
+beamformer_replay_push_parameters(BeamformerCtx *ctx, BeamformerReplayParametersV1 *rp)
+{
+	BeamformerSharedMemory   *sm = ctx->shared_memory.region;
+	BeamformerParameterBlock *pb = beamformer_parameter_block_lock(&ctx->shared_memory, 0, -1);
+	BeamformerParameters     *bp = &pb->parameters;
+
+	mem_copy(bp->xdc_transform,       rp->xdc_transform,     sizeof(bp->xdc_transform));
+	mem_copy(bp->xdc_element_pitch,   rp->xdc_element_pitch, sizeof(bp->xdc_element_pitch));
+	mem_copy(bp->raw_data_dimensions, rp->raw_data_dim,      sizeof(bp->raw_data_dimensions));
+
+	bp->sample_count           = rp->decoded_data_dim[0];
+	bp->channel_count          = rp->decoded_data_dim[1];
+	bp->acquisition_count      = rp->decoded_data_dim[2];
+	bp->transmit_mode          = (u8)((rp->transmit_mode & 2) >> 1);
+	bp->receive_mode           = (u8)((rp->transmit_mode & 1) >> 0);
+	bp->decode                 = (u8)rp->decode_mode;
+	bp->das_shader_id          = rp->beamform_mode;
+	bp->time_offset            = rp->time_offset;
+	bp->sampling_frequency     = rp->sampling_frequency;
+	bp->speed_of_sound         = rp->speed_of_sound;
+	bp->demodulation_frequency = rp->sampling_frequency / 4;
+	bp->decimation_rate        = 1;
+	bp->interpolate            = 1;
+	bp->f_number               = 0.5f;
+	bp->beamform_plane         = 0;
+
+	bp->output_points[0] = 512;
+	bp->output_points[1] = 1;
+	bp->output_points[2] = 1024;
+	bp->output_points[3] = 1;
+
+	bp->output_min_coordinate[0] = -60e-3f;
+	bp->output_min_coordinate[2] =  10e-3f;
+	bp->output_max_coordinate[0] =  60e-3f;
+	bp->output_max_coordinate[2] = 165e-3f;
+
+	static_assert(countof(rp->channel_mapping) == countof(pb->channel_mapping),
+	              "replay parameters must hold a full channel mapping");
+	mem_copy(pb->channel_mapping, rp->channel_mapping, sizeof(pb->channel_mapping));
+	for (i16 i = 0; i < countof(pb->sparse_elements); i++)
+		pb->sparse_elements[i] = rp->sparse_elements[0] == -1 ? i : rp->sparse_elements[i];
+	for (u32 i = 0; i < countof(pb->focal_vectors); i++)
+		pb->focal_vectors[i] = (v2){{rp->transmit_angles[i], rp->focal_depths[i]}};
+
+	pb->pipeline.shaders[0]   = BeamformerShaderKind_Demodulate;
+	pb->pipeline.shaders[1]   = BeamformerShaderKind_Decode;
+	pb->pipeline.shaders[2]   = BeamformerShaderKind_DAS;
+	pb->pipeline.shader_count = 3;
+	pb->pipeline.data_kind    = BeamformerDataKind_Int16;
+
+	for (u32 region = 0; region < BeamformerParameterBlockRegion_Count; region++)
+		publish_parameter_block_region(sm, 0, region);
+	beamformer_parameter_block_unlock(&ctx->shared_memory, 0);
+
+	BeamformWorkPayload *payload;
+	BeamformWork *work = beamform_work_queue_push_with_payload(&sm->external_work_queue, &payload);
+	work->kind = BeamformerWorkKind_CreateFilter;
+	work->create_filter_context.kind = BeamformerFilterKind_Kaiser;
+	payload->filter_parameters.Kaiser.beta             = 5.65f;
+	payload->filter_parameters.Kaiser.cutoff_frequency = 2.0e6f;
+	payload->filter_parameters.Kaiser.length           = 36;
+	payload->filter_parameters.sampling_frequency      = rp->sampling_frequency / 2;
+	beamform_work_queue_push_commit(&sm->external_work_queue, work);
+}
+
+function void
+beamformer_replay_start(BeamformerCtx *ctx, BeamformerOptions *options, MemoryCopyEngine *copy_engine,
+                        Arena *memory)
+{
+	Stream err = stream_alloc(memory, KB(4));
+	BeamformerReplay *r = push_struct(memory, BeamformerReplay);
+
+	void *zstd = os_load_library(OS_ZSTD_LIB_NAME, 0, &err);
+	#define X(ret, name, params) r->name = os_lookup_dynamic_symbol(zstd, #name, &err);
+	ZstdProcedureList
+	#undef X
+	if (!r->ZSTD_getFrameContentSize || !r->ZSTD_decompress || !r->ZSTD_isError) {
+		stream_append_s8(&err, s8("replay: zstd is required to replay a study\n"));
+		os_fatal(stream_to_s8(&err));
+	}
+
+	s8 parameters_path = c_str_to_s8(options->replay_path);
+	s8 parameters      = os_map_file(options->replay_path);
+	BeamformerReplayParametersV1 *rp = (BeamformerReplayParametersV1 *)parameters.data;
+	if (parameters.len != sizeof(*rp) || rp->magic != BEAMFORMER_REPLAY_MAGIC || rp->version != 1) {
+		stream_append_s8s(&err, s8("replay: invalid parameters file: "), parameters_path, s8("\n"));
+		os_fatal(stream_to_s8(&err));
+	}
+
+	u64 frame_size = (u64)rp->raw_data_dim[0] * rp->raw_data_dim[1] * sizeof(i16);
+	r->frame_size      = (u32)frame_size;
+	r->frames_per_file = MAX(1, rp->raw_data_dim[2]);
+	/* NOTE(rnp): the upload reads each frame rounded up to 64 bytes */
+	r->frames_per_slot = (u32)MIN(r->frames_per_file, (BEAMFORMER_RF_SLOT_SIZE - 64) / MAX(frame_size, 1));
+	if (frame_size == 0 || r->frames_per_slot == 0) {
+		stream_append_s8(&err, s8("replay: study frames do not fit in an RF slot\n"));
+		os_fatal(stream_to_s8(&err));
+	}
+
+	/* NOTE(rnp): frame files sit next to the parameters: <base>_NN.zst */
+	s8 base = parameters_path;
+	if (base.len > 3 && s8_equal(s8_cut_head(base, base.len - 3), s8(".bp")))
+		base.len -= 3;
+
+	Stream path = stream_alloc(memory, KB(4));
+	stream_append_s8(&path, base);
+	i32 base_index = path.widx;
+
+	#define replay_frame_file_path(index) \
+		(stream_reset(&path, base_index), stream_append_byte(&path, '_'),    \
+		 stream_append_u64_width(&path, (index), 2), stream_append_s8(&path, s8(".zst")), \
+		 stream_append_byte(&path, 0), (char *)path.data)
+
+	while (!path.errors && os_file_exists(replay_frame_file_path(r->file_count)))
+		r->file_count++;
+
+	r->files = push_array(memory, s8, r->file_count);
+	for (u32 i = 0; i < r->file_count; i++) {
+		r->files[i] = os_map_file(replay_frame_file_path(i));
+		u64 size = r->files[i].len > 0 ? r->ZSTD_getFrameContentSize(r->files[i].data, (uz)r->files[i].len) : 0;
+		if (size != frame_size * r->frames_per_file) {
+			stream_append_s8s(&err, s8("replay: frame file doesn't match parameters: "),
+			                  c_str_to_s8((char *)path.data), s8("\n"));
+			os_fatal(stream_to_s8(&err));
+		}
+	}
+	#undef replay_frame_file_path
+
+	if (r->file_count == 0) {
+		stream_append_s8s(&err, s8("replay: no frame files found for: "), base, s8("\n"));
+		os_fatal(stream_to_s8(&err));
+	}
+
+	beamformer_replay_push_parameters(ctx, rp);
+
+	r->shared_memory       = ctx->shared_memory.region;
+	r->copy_engine         = copy_engine;
+	r->upload_worker_sync  = &ctx->os.upload_worker.sync_variable;
+	r->compute_worker_sync = &ctx->os.compute_workers[0].sync_variable;
+	if (options->replay_rate)
+		r->frame_period = os_get_timer_frequency() / options->replay_rate;
+
+	for EachElement(r->workers, it) {
+		BeamformerReplayWorker *w = r->workers + it;
+		w->replay        = r;
+		w->index         = (u32)it;
+		w->sync_variable = it > 0;
+		w->frames        = os_alloc_arena((iz)frame_size * r->frames_per_file).beg;
+
+		Stream name = arena_stream(*memory);
+		stream_append_s8(&name, s8("[replay "));
+		stream_append_u64(&name, it);
+		stream_append_byte(&name, ']');
+		os_create_thread(*memory, (iptr)w, arena_stream_commit_zero(memory, &name),
+		                 beamformer_replay_worker_entry_point);
+	}
+}
@@ -0,0 +1,169 @@
+/* See LICENSE for license details. */
+
+/* NOTE(rnp): DeltaBlocks layout. each block holds up to RF_DELTA_BLOCK_SAMPLES samples:
+ *   u8  width: bits per delta [0, 17]
+ *   i16 first sample (little endian)
+ *   zigzag encoded deltas to the previous sample packed LSB first in width bits,
+ *   padded to a byte boundary
+ * oversampled RF changes slowly between samples so most blocks need far fewer than 16 bits */
+#define RF_DELTA_BLOCK_SAMPLES   (64)
+#define RF_DELTA_BLOCK_MAX_WIDTH (17)
+
+typedef struct {
+	u8  *data;
+	uz   size;
+	uz   index;
+	u64  buffer;
+	u32  count;
+	b32  errors;
+} RFBitStream;
+
+function u32
+rf_bit_stream_read(RFBitStream *bs, u32 bits)
+{
+	while (bs->count < bits) {
+		u64 byte = 0;
+		if (bs->index < bs->size) byte = bs->data[bs->index++];
+		else                      bs->errors = 1;
+		bs->buffer |= byte << bs->count;
+		bs->count  += 8;
+	}
+	u32 result = (u32)(bs->buffer & ((1ULL << bits) - 1));
+	bs->buffer >>= bits;
+	bs->count   -= bits;
+	return result;
+}
+
+function void
+rf_bit_stream_write(RFBitStream *bs, u32 value, u32 bits)
+{
+	bs->buffer |= (u64)(value & ((1ULL << bits) - 1)) << bs->count;
+	bs->count  += bits;
+	while (bs->count >= 8) {
+		if (bs->index < bs->size) bs->data[bs->index++] = (u8)bs->buffer;
+		else                      bs->errors = 1;
+		bs->buffer >>= 8;
+		bs->count   -= 8;
+	}
+}
+
+/* NOTE(rnp): drops any partially consumed byte */
+function void
+rf_bit_stream_align(RFBitStream *bs, b32 write)
+{
+	if (write && bs->count) rf_bit_stream_write(bs, 0, 8 - bs->count);
+	bs->buffer = 0;
+	bs->count  = 0;
+}
+
+function i16
+rf_sign_extend(u32 value, u32 bits)
+{
+	i16 result = (i16)((i32)(value << (32 - bits)) >> (32 - bits));
+	return result;
+}
+
+function u32
+rf_encoding_bits_per_sample(BeamformerRFEncoding encoding)
+{
+	#define X(type, id, bits, ...) bits,
+	read_only local_persist u32 bits_per_sample[] = {BEAMFORMER_RF_ENCODING_LIST 0};
+	#undef X
+	u32 result = bits_per_sample[MIN((u32)encoding, countof(bits_per_sample) - 1)];
+	return result;
+}
+
+/* NOTE(rnp): largest possible encoded size; used by clients to size output buffers */
+function u64
+rf_encoded_size_bound(BeamformerRFEncoding encoding, u32 sample_count)
+{
+	u64 result = 0;
+	if (encoding == BeamformerRFEncoding_DeltaBlocks) {
+		u64 blocks = (sample_count + RF_DELTA_BLOCK_SAMPLES - 1) / RF_DELTA_BLOCK_SAMPLES;
+		result = blocks * (3 + ((RF_DELTA_BLOCK_SAMPLES - 1) * RF_DELTA_BLOCK_MAX_WIDTH + 7) / 8);
+	} else {
+		result = ((u64)sample_count * rf_encoding_bits_per_sample(encoding) + 7) / 8;
+	}
+	return result;
+}
+
+/* NOTE(rnp): returns the number of bytes written or 0 if out was too small */
+function uz
+rf_encode(BeamformerRFEncoding encoding, u8 *out, uz out_size, i16 *samples, u32 sample_count)
+{
+	RFBitStream bs = {.data = out, .size = out_size};
+	switch (encoding) {
+	case BeamformerRFEncoding_DeltaBlocks:{
+		for (u32 start = 0; start < sample_count; start += RF_DELTA_BLOCK_SAMPLES) {
+			u32 count = MIN(RF_DELTA_BLOCK_SAMPLES, sample_count - start);
+			i16 *block = samples + start;
+
+			u32 max_zigzag = 0;
+			for (u32 i = 1; i < count; i++) {
+				i32 delta = (i32)block[i] - (i32)block[i - 1];
+				max_zigzag |= ((u32)delta << 1) ^ (u32)(delta >> 31);
+			}
+			u32 width = 32 - clz_u32(max_zigzag);
+
+			rf_bit_stream_write(&bs, width, 8);
+			rf_bit_stream_write(&bs, (u16)block[0], 16);
+			for (u32 i = 1; i < count; i++) {
+				i32 delta = (i32)block[i] - (i32)block[i - 1];
+				rf_bit_stream_write(&bs, ((u32)delta << 1) ^ (u32)(delta >> 31), width);
+			}
+			rf_bit_stream_align(&bs, 1);
+		}
+	}break;
+	default:{
+		u32 bits = rf_encoding_bits_per_sample(encoding);
+		for (u32 i = 0; i < sample_count; i++)
+			rf_bit_stream_write(&bs, (u16)samples[i], bits);
+		rf_bit_stream_align(&bs, 1);
+	}break;
+	}
+
+	uz result = bs.errors ? 0 : bs.index;
+	return result;
+}
+
+/* NOTE(rnp): data comes from another process; anything malformed is reported and the
+ * remaining samples are zeroed instead of reading out of bounds */
+function b32
+rf_decode(BeamformerRFEncoding encoding, i16 *out, u32 sample_count, u8 *data, uz data_size)
+{
+	RFBitStream bs = {.data = data, .size = data_size};
+	u32 decoded = 0;
+	switch (encoding) {
+	case BeamformerRFEncoding_DeltaBlocks:{
+		while (decoded < sample_count && !bs.errors) {
+			u32 count = MIN(RF_DELTA_BLOCK_SAMPLES, sample_count - decoded);
+			u32 width = rf_bit_stream_read(&bs, 8);
+			if (width > RF_DELTA_BLOCK_MAX_WIDTH) {
+				bs.errors = 1;
+				break;
+			}
+
+			i32 value = (i16)rf_bit_stream_read(&bs, 16);
+			out[decoded++] = (i16)value;
+			for (u32 i = 1; i < count; i++) {
+				u32 zigzag = width ? rf_bit_stream_read(&bs, width) : 0;
+				value += (i32)(zigzag >> 1) ^ -(i32)(zigzag & 1);
+				out[decoded++] = (i16)value;
+			}
+			rf_bit_stream_align(&bs, 0);
+		}
+	}break;
+	case BeamformerRFEncoding_Packed12:
+	case BeamformerRFEncoding_Packed14:
+	{
+		u32 bits = rf_encoding_bits_per_sample(encoding);
+		for (; decoded < sample_count; decoded++)
+			out[decoded] = rf_sign_extend(rf_bit_stream_read(&bs, bits), bits);
+	}break;
+	default:{ bs.errors = 1; }break;
+	}
+
+	if (bs.errors) mem_clear(out + decoded, 0, (iz)((sample_count - decoded) * sizeof(*out)));
+	b32 result = !bs.errors;
+	return result;
+}
@@ -1,7 +1,13 @@
 /* See LICENSE for license details. */
-#if   DataKind == DataKind_Float32
+#define ComplexData (DataKind == DataKind_Float32Complex || DataKind == DataKind_Float16Complex)
+
+#if   DataKind == DataKind_Float32 || DataKind == DataKind_Float16
   #define SAMPLE_TYPE           float
-  #define TEXTURE_KIND          r32f
+  #if DataKind == DataKind_Float16
+    #define TEXTURE_KIND        r16f
+  #else
+    #define TEXTURE_KIND        r32f
+  #endif
   #define RESULT_TYPE_CAST(a)   (a).x
   #define OUTPUT_TYPE_CAST(a)   vec4((a).x, 0, 0, 0)
   #if (ShaderFlags & ShaderFlags_Fast)
@@ -10,9 +16,13 @@
     #define RESULT_TYPE         vec2
     #define RESULT_LAST_INDEX   1
   #endif
-#elif DataKind == DataKind_Float32Complex
+#elif ComplexData
   #define SAMPLE_TYPE           vec2
-  #define TEXTURE_KIND          rg32f
+  #if DataKind == DataKind_Float16Complex
+    #define TEXTURE_KIND        rg16f
+  #else
+    #define TEXTURE_KIND        rg32f
+  #endif
   #define RESULT_TYPE_CAST(a)   (a).xy
   #define OUTPUT_TYPE_CAST(a)   vec4((a).xy, 0, 0)
   #if (ShaderFlags & ShaderFlags_Fast)
@@ -43,7 +53,7 @@ layout(rg32f, binding = 2) readonly  restrict uniform image1D  focal_vectors;
 
 #define C_SPLINE 0.5
 
-#if DataKind == DataKind_Float32Complex
+#if ComplexData
 vec2 rotate_iq(vec2 iq, float time)
 {
 	float arg    = radians(360) * demodulation_frequency * time;
@@ -80,10 +90,10 @@ SAMPLE_TYPE cubic(int base_index, float index)
 	SAMPLE_TYPE T1 = C_SPLINE * (P2 - samples[0]);
 	SAMPLE_TYPE T2 = C_SPLINE * (samples[3] - P1);
 
-#if   DataKind == DataKind_Float32
+#if !ComplexData
 	vec4 C = vec4(P1.x, P2.x, T1.x, T2.x);
 	float result = dot(S, h * C);
-#elif DataKind == DataKind_Float32Complex
+#else
 	mat2x4 C = mat2x4(vec4(P1.x, P2.x, T1.x, T2.x), vec4(P1.y, P2.y, T1.y, T2.y));
 	vec2 result = S * h * C;
 #endif
@@ -0,0 +1,105 @@
+/* See LICENSE for license details. */
+#if   DataKind == DataKind_Float32
+  #define TEXTURE_KIND r32f
+#elif DataKind == DataKind_Float32Complex
+  #define TEXTURE_KIND rg32f
+#elif DataKind == DataKind_Float16
+  #define TEXTURE_KIND r16f
+#elif DataKind == DataKind_Float16Complex
+  #define TEXTURE_KIND rg16f
+#else
+  #error DataKind unsupported for Export
+#endif
+
+#define ComplexData (DataKind == DataKind_Float32Complex || DataKind == DataKind_Float16Complex)
+
+/* NOTE: Reduces a frame to what a client asked for before it is read back. Each invocation
+ * produces whole 32 bit words of output so that packed 8 and 16 bit samples never need to
+ * be combined across invocations. The dispatch size is capped so invocations loop over any
+ * remaining words. */
+
+layout(TEXTURE_KIND, binding = 0) readonly uniform image3D u_frame;
+
+layout(std430, binding = 1) writeonly restrict buffer export_buffer {
+	uint out_data[];
+};
+
+vec4 load_voxel(uint index)
+{
+	uvec3 points = uvec3(u_output_points);
+	ivec3 voxel;
+	voxel.x = int(index % points.x);
+	index  /= points.x;
+	voxel.y = int(index % points.y);
+	voxel.z = int(index / points.y);
+
+	vec4 result = imageLoad(u_frame, u_roi_offset + voxel * u_decimation);
+	return result;
+}
+
+/* NOTE: samples are written in the frame's own format; half samples are packed in pairs */
+uint raw_word(uint word, uint voxel_count)
+{
+#if   DataKind == DataKind_Float32
+	uint result = floatBitsToUint(load_voxel(word).x);
+#elif DataKind == DataKind_Float32Complex
+	uint result = floatBitsToUint(load_voxel(word / 2)[word & 1]);
+#elif DataKind == DataKind_Float16
+	vec2 pair   = vec2(load_voxel(2 * word).x, 0);
+	if (2 * word + 1 < voxel_count) pair.y = load_voxel(2 * word + 1).x;
+	uint result = packHalf2x16(pair);
+#elif DataKind == DataKind_Float16Complex
+	uint result = packHalf2x16(load_voxel(word).xy);
+#endif
+	return result;
+}
+
+float magnitude(uint index)
+{
+	vec4 value = load_voxel(index);
+#if ComplexData
+	float result = length(value.xy);
+#else
+	float result = abs(value.x);
+#endif
+	return result;
+}
+
+uint quantize(float value, float max_value)
+{
+	/* NOTE: 20 * log10(x) */
+	float db     = 6.0205999 * log2(max(value / u_reference, 1e-30));
+	float scaled = clamp((db + u_dynamic_range) / u_dynamic_range, 0.0, 1.0);
+	uint  result = uint(round(scaled * max_value));
+	return result;
+}
+
+void main()
+{
+	uint voxel_count = uint(u_output_points.x * u_output_points.y * u_output_points.z);
+	uint stride      = gl_NumWorkGroups.x * gl_WorkGroupSize.x;
+	for (uint word = gl_GlobalInvocationID.x; word < u_word_count; word += stride) {
+		uint value = 0;
+		switch (u_processing) {
+		case ExportProcessing_None:{
+			value = raw_word(word, voxel_count);
+		}break;
+		case ExportProcessing_Magnitude:{
+			value = floatBitsToUint(magnitude(word));
+		}break;
+		case ExportProcessing_Decibel8:{
+			for (uint i = 0; i < 4; i++) {
+				uint index = 4 * word + i;
+				if (index < voxel_count) value |= quantize(magnitude(index), 255.0) << (8 * i);
+			}
+		}break;
+		case ExportProcessing_Decibel16:{
+			for (uint i = 0; i < 2; i++) {
+				uint index = 2 * word + i;
+				if (index < voxel_count) value |= quantize(magnitude(index), 65535.0) << (16 * i);
+			}
+		}break;
+		}
+		out_data[word] = value;
+	}
+}
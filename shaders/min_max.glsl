@@ -1,24 +1,90 @@
 /* See LICENSE for license details. */
+#if   DataKind == DataKind_Float32
+  #define TEXTURE_KIND r32f
+#elif DataKind == DataKind_Float32Complex
+  #define TEXTURE_KIND rg32f
+#elif DataKind == DataKind_Float16
+  #define TEXTURE_KIND r16f
+#elif DataKind == DataKind_Float16Complex
+  #define TEXTURE_KIND rg16f
+#else
+  #error DataKind unsupported for MinMax
+#endif
 
-/* NOTE: Does a binary search in 3D for smallest and largest output values */
-layout(local_size_x = 32, local_size_y = 1, local_size_z = 32) in;
+#define ComplexData (DataKind == DataKind_Float32Complex || DataKind == DataKind_Float16Complex)
 
-layout(rg32f, binding = 0) readonly  uniform image3D u_out_data_tex;
-layout(rg32f, binding = 1) writeonly uniform image3D u_mip_view_tex;
+/* NOTE: Builds a min/max magnitude pyramid in the frame's mips. Each invocation reduces a
+ * 2x2x2 block of the source level; the workgroup then continues the reduction in shared
+ * memory so that a single dispatch writes up to 3 mip levels. Complex frames store
+ * (min, max) while single channel frames can only store the max. Source coordinates are
+ * clamped so that odd and degenerate (size 1) dimensions only ever reduce real data. */
+
+layout(TEXTURE_KIND, binding = 0) readonly  uniform image3D u_source_tex;
+layout(TEXTURE_KIND, binding = 1) writeonly uniform image3D u_mip_tex_1;
+layout(TEXTURE_KIND, binding = 2) writeonly uniform image3D u_mip_tex_2;
+layout(TEXTURE_KIND, binding = 3) writeonly uniform image3D u_mip_tex_3;
+
+shared vec2 s_level_1[MIN_MAX_LOCAL_SIZE][MIN_MAX_LOCAL_SIZE][MIN_MAX_LOCAL_SIZE];
+shared vec2 s_level_2[MIN_MAX_LOCAL_SIZE / 2][MIN_MAX_LOCAL_SIZE / 2][MIN_MAX_LOCAL_SIZE / 2];
+
+vec2 combine(vec2 a, vec2 b)
+{
+	vec2 result = vec2(min(a.x, b.x), max(a.y, b.y));
+	return result;
+}
+
+vec2 load_source(ivec3 coord)
+{
+	vec4 value = imageLoad(u_source_tex, min(coord, imageSize(u_source_tex) - 1));
+	vec2 result;
+#if ComplexData
+	if (u_mip_map == 0) result = vec2(length(value.xy));
+	else                result = value.xy;
+#else
+	if (u_mip_map == 0) result = vec2(abs(value.x));
+	else                result = value.xx;
+#endif
+	return result;
+}
+
+vec4 output_cast(vec2 min_max)
+{
+#if ComplexData
+	vec4 result = vec4(min_max, 0, 1);
+#else
+	vec4 result = vec4(min_max.y, 0, 0, 1);
+#endif
+	return result;
+}
 
 void main()
 {
-	ivec3 out_coord = ivec3(gl_GlobalInvocationID.xyz);
-
-	ivec3 idx = out_coord * 2;
-	vec2 min_max = vec2(1000000000, 0);
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 2; j++) {
-			vec2 a    = imageLoad(u_out_data_tex, idx + ivec3(i, j, 0)).xy;
-			vec2 b    = imageLoad(u_out_data_tex, idx + ivec3(i, j, 1)).xy;
-			min_max.x = min(min_max.x, min(a.x, b.x));
-			min_max.y = max(min_max.y, max(a.y, b.y));
+	ivec3 local = ivec3(gl_LocalInvocationID);
+	ivec3 coord = ivec3(gl_GlobalInvocationID);
+
+	vec2 min_max = vec2(3.4e38, 0);
+	for (int i = 0; i < 8; i++)
+		min_max = combine(min_max, load_source(2 * coord + ivec3(i & 1, (i >> 1) & 1, i >> 2)));
+	imageStore(u_mip_tex_1, coord, output_cast(min_max));
+	s_level_1[local.z][local.y][local.x] = min_max;
+
+	barrier();
+
+	if (u_level_count > 1 && all(equal(local & 1, ivec3(0)))) {
+		for (int i = 1; i < 8; i++) {
+			ivec3 l = local + ivec3(i & 1, (i >> 1) & 1, i >> 2);
+			min_max = combine(min_max, s_level_1[l.z][l.y][l.x]);
 		}
+		ivec3 half_local = local / 2;
+		imageStore(u_mip_tex_2, coord / 2, output_cast(min_max));
+		s_level_2[half_local.z][half_local.y][half_local.x] = min_max;
+	}
+
+	barrier();
+
+	if (u_level_count > 2 && all(equal(local, ivec3(0)))) {
+		for (int i = 1; i < 8; i++)
+			min_max = combine(min_max, s_level_2[i >> 2][(i >> 1) & 1][i & 1]);
+		imageStore(u_mip_tex_3, coord / 4, output_cast(min_max));
 	}
-	imageStore(u_mip_view_tex, out_coord, vec4(min_max, 0, 1));
 }
@@ -1,12 +1,46 @@
 /* See LICENSE for license details. */
+#if   DataKind == DataKind_Float32
+  #define TEXTURE_KIND     r32f
+  #define ACCUMULATOR_KIND r32f
+#elif DataKind == DataKind_Float32Complex
+  #define TEXTURE_KIND     rg32f
+  #define ACCUMULATOR_KIND rg32f
+#elif DataKind == DataKind_Float16
+  #define TEXTURE_KIND     r16f
+  #define ACCUMULATOR_KIND r32f
+#elif DataKind == DataKind_Float16Complex
+  #define TEXTURE_KIND     rg16f
+  #define ACCUMULATOR_KIND rg32f
+#else
+  #error DataKind unsupported for Sum
+#endif
+
 layout(local_size_x = 32, local_size_y = 1, local_size_z = 32) in;
 
-layout(rg32f, binding = 0)           uniform image3D u_out_img;
-layout(rg32f, binding = 1) readonly  uniform image3D u_in_img;
+layout(TEXTURE_KIND,     binding = 0)           uniform image3D u_out_img;
+layout(TEXTURE_KIND,     binding = 1) readonly  uniform image3D u_in_img;
+layout(TEXTURE_KIND,     binding = 2) readonly  uniform image3D u_leaving_img;
+layout(ACCUMULATOR_KIND, binding = 3)           uniform image3D u_accumulator_img;
 
 void main()
 {
 	ivec3 voxel = ivec3(gl_GlobalInvocationID);
-	vec4  sum   = imageLoad(u_out_img, voxel) + u_sum_prescale * imageLoad(u_in_img, voxel);
-	imageStore(u_out_img, voxel, sum);
+	switch (u_sum_mode) {
+	case SumMode_Full:{
+		vec4 sum = imageLoad(u_out_img, voxel) + u_sum_prescale * imageLoad(u_in_img, voxel);
+		imageStore(u_out_img, voxel, sum);
+	}break;
+	case SumMode_Incremental:{
+		vec4 sum = imageLoad(u_accumulator_img, voxel) + imageLoad(u_in_img, voxel);
+		sum     -= imageLoad(u_leaving_img, voxel);
+		imageStore(u_accumulator_img, voxel, sum);
+		imageStore(u_out_img,         voxel, u_sum_prescale * sum);
+	}break;
+	case SumMode_Exponential:{
+		vec4 average = imageLoad(u_accumulator_img, voxel);
+		average      = mix(average, imageLoad(u_in_img, voxel), u_sum_prescale);
+		imageStore(u_accumulator_img, voxel, average);
+		imageStore(u_out_img,         voxel, average);
+	}break;
+	}
 }
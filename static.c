@@ -29,9 +29,10 @@ function FILE_WATCH_CALLBACK_FN(debug_reload)
 	BeamformerInput *input = (BeamformerInput *)user_data;
 	Stream err             = arena_stream(arena);
 
-	/* NOTE(rnp): spin until compute thread finishes its work (we will probably
+	/* NOTE(rnp): spin until compute threads finish their work (we will probably
 	 * never reload while compute is in progress but just incase). */
-	spin_wait(!atomic_load_u32(&os->compute_worker.asleep));
+	for (u32 i = 0; i < os->compute_worker_count; i++)
+		spin_wait(!atomic_load_u32(&os->compute_workers[i].asleep));
 	spin_wait(!atomic_load_u32(&os->upload_worker.asleep));
 
 	os_unload_library(debug_lib);
@@ -114,6 +115,20 @@ get_gl_params(GLParams *gl, Stream *err)
 	#define X(glname, name, suffix) glGetIntegerv(GL_##glname, &gl->name);
 	GL_PARAMETERS
 	#undef X
+
+	switch (gl->vendor_id) {
+	case GL_VENDOR_AMD:{
+		/* NOTE(rnp): {total free, largest free block, total aux free, largest aux free block} */
+		i32 free_memory[4] = {0};
+		glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, free_memory);
+		gl->free_memory_kb = free_memory[0];
+	}break;
+	case GL_VENDOR_NVIDIA:{
+		glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX,   &gl->total_memory_kb);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &gl->free_memory_kb);
+	}break;
+	default:{}break;
+	}
 }
 
 function void
@@ -163,6 +178,14 @@ dump_gl_params(GLParams *gl, Arena a, OS *os)
 		stream_append_byte(&s, '\n');
 	GL_PARAMETERS
 	#undef X
+	stream_append_s8(&s, s8("total_memory:"));
+	stream_pad(&s, ' ', max_width - (i32)s8("total_memory:").len);
+	stream_append_i64(&s, gl->total_memory_kb);
+	stream_append_s8(&s, s8(" [kB]\n"));
+	stream_append_s8(&s, s8("free_memory:"));
+	stream_pad(&s, ' ', max_width - (i32)s8("free_memory:").len);
+	stream_append_i64(&s, gl->free_memory_kb);
+	stream_append_s8(&s, s8(" [kB]\n"));
 	stream_append_s8(&s, s8("-----------------------\n"));
 	os_write_file(os->error_handle, stream_to_s8(&s));
 #endif
@@ -179,12 +202,13 @@ function FILE_WATCH_CALLBACK_FN(reload_shader_indirect)
 {
 	ShaderReloadContext *src = (typeof(src))user_data;
 	BeamformerCtx *ctx = src->beamformer_context;
-	BeamformWork *work = beamform_work_queue_push(ctx->beamform_work_queue);
+	BeamformWorkPayload *payload;
+	BeamformWork *work = beamform_work_queue_push_with_payload(ctx->beamform_work_queue, &payload);
 	if (work) {
-		work->kind = BeamformerWorkKind_ReloadShader,
-		work->shader_reload_context = src;
-		beamform_work_queue_push_commit(ctx->beamform_work_queue);
-		os_wake_waiters(&os->compute_worker.sync_variable);
+		work->kind = BeamformerWorkKind_ReloadShader;
+		payload->shader_reload_context = src;
+		beamform_work_queue_push_commit(ctx->beamform_work_queue, work);
+		os_wake_waiters(&os->compute_workers[0].sync_variable);
 	}
 	return 1;
 }
@@ -254,18 +278,22 @@ void glfwWindowHint(i32, i32);
 iptr glfwCreateWindow(i32, i32, char *, iptr, iptr);
 void glfwMakeContextCurrent(iptr);
 
+/* NOTE(rnp): threads which don't poll the shared memory (sm == 0) are always put to sleep.
+ * with a timeout the thread also returns once it has slept that long without being woken */
 function void
-worker_thread_sleep(GLWorkerThreadContext *ctx, BeamformerSharedMemory *sm)
+worker_thread_sleep(GLWorkerThreadContext *ctx, BeamformerSharedMemory *sm, u32 timeout_ms)
 {
 	for (;;) {
 		i32 expected = 0;
 		if (atomic_cas_u32(&ctx->sync_variable, &expected, 1))
 			break;
 
-		if (!atomic_load_u32(&sm->live_imaging_parameters.active)) {
+		if (!sm || !atomic_load_u32(&sm->live_imaging_parameters.active)) {
 			atomic_store_u32(&ctx->asleep, 1);
-			os_wait_on_value(&ctx->sync_variable, 1, (u32)-1);
+			b32 woken = os_wait_on_value(&ctx->sync_variable, 1, timeout_ms);
 			atomic_store_u32(&ctx->asleep, 0);
+			if (!woken && timeout_ms != (u32)-1)
+				break;
 		}
 	}
 }
@@ -277,12 +305,24 @@ function OS_THREAD_ENTRY_POINT_FN(compute_worker_thread_entry_point)
 	glfwMakeContextCurrent(ctx->window_handle);
 	ctx->gl_context = os_get_native_gl_context(ctx->window_handle);
 
-	BeamformerCtx *beamformer = (BeamformerCtx *)ctx->user_context;
-	glCreateQueries(GL_TIME_ELAPSED, countof(beamformer->compute_context.shader_timer_ids),
-	                beamformer->compute_context.shader_timer_ids);
+	BeamformerComputeWorker *worker = (BeamformerComputeWorker *)ctx->user_context;
+	for EachElement(worker->timer_query_sets, it) {
+		BeamformerTimerQuerySet *qs = worker->timer_query_sets + it;
+		glCreateQueries(GL_TIME_ELAPSED, countof(qs->queries), qs->queries);
+	}
+
+	/* NOTE(rnp): only the first worker polls for new work during live imaging; the others
+	 * are woken when work is handed to them */
+	BeamformerSharedMemory *sm = 0;
+	if (worker->index == 0) sm = worker->beamformer->shared_memory.region;
 
 	for (;;) {
-		worker_thread_sleep(ctx, beamformer->shared_memory.region);
+		/* NOTE(rnp): a client may be waiting on an export which is still being read back;
+		 * wake up periodically to check on it instead of sleeping until new work arrives */
+		u32 timeout_ms = (u32)-1;
+		if (worker->readback_read_index != worker->readback_write_index)
+			timeout_ms = BEAMFORMER_READBACK_POLL_MS;
+		worker_thread_sleep(ctx, sm, timeout_ms);
 		asan_poison_region(ctx->arena.beg, ctx->arena.end - ctx->arena.beg);
 		beamformer_complete_compute(ctx->user_context, &ctx->arena, ctx->gl_context);
 	}
@@ -299,12 +339,11 @@ function OS_THREAD_ENTRY_POINT_FN(upload_worker_thread_entry_point)
 	ctx->gl_context = os_get_native_gl_context(ctx->window_handle);
 
 	BeamformerUploadThreadContext *up = (typeof(up))ctx->user_context;
-	glCreateQueries(GL_TIMESTAMP, 1, &up->rf_buffer->data_timestamp_query);
-	/* NOTE(rnp): start this here so we don't have to worry about it being started or not */
-	glQueryCounter(up->rf_buffer->data_timestamp_query, GL_TIMESTAMP);
+	glCreateQueries(GL_TIMESTAMP, countof(up->rf_buffer->data_timestamp_queries),
+	                up->rf_buffer->data_timestamp_queries);
 
 	for (;;) {
-		worker_thread_sleep(ctx, up->shared_memory->region);
+		worker_thread_sleep(ctx, up->shared_memory->region, (u32)-1);
 		asan_poison_region(ctx->arena.beg, ctx->arena.end - ctx->arena.beg);
 		beamformer_rf_upload(up, ctx->arena);
 	}
@@ -314,9 +353,116 @@ function OS_THREAD_ENTRY_POINT_FN(upload_worker_thread_entry_point)
 	return 0;
 }
 
+#include "replay.c"
+#include "beamformer_remote.c"
+#include "remote.c"
+
 function void
-setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input)
+usage(char *argv0, Arena arena)
+{
+	Stream s = arena_stream(arena);
+	stream_append_s8s(&s, c_str_to_s8(argv0), s8(" [--compute-workers n] [--rf-ring-depth n] "
+	                                             "[--copy-helpers n] [--copy-threshold bytes] [--frame-cache-budget mb] "
+	                                             "[--replay study.bp] [--replay-rate hz] [--listen address] "
+	                                             "[--shared-memory-size mb] [--huge-pages] [--prefault] [--mlock]\n"));
+	stream_append_s8(&s, s8("    --compute-workers n:      number of GL contexts running compute work [1, "));
+	stream_append_u64(&s, OS_MAX_COMPUTE_WORKERS);
+	stream_append_s8(&s, s8("] (default: 1; CUDA stages need 1)\n"));
+	stream_append_s8(&s, s8("    --rf-ring-depth n:        RF uploads which can be in flight [2, "));
+	stream_append_u64(&s, BEAMFORMER_RF_RING_MAX_DEPTH);
+	stream_append_s8(&s, s8("] (default: sized from GPU memory)\n"));
+	stream_append_s8(&s, s8("    --copy-helpers n:         extra threads used for large RF copies [0, "));
+	stream_append_u64(&s, MEMORY_COPY_MAX_HELPERS);
+	stream_append_s8(&s, s8("] (default: "));
+	stream_append_u64(&s, MEMORY_COPY_DEFAULT_HELPERS);
+	stream_append_s8(&s, s8(")\n"));
+	stream_append_s8(&s, s8("    --copy-threshold bytes:   smallest RF copy split across copy helpers (default: "));
+	stream_append_u64(&s, MEMORY_COPY_DEFAULT_THRESHOLD);
+	stream_append_s8(&s, s8(")\n"));
+	stream_append_s8(&s, s8("    --frame-cache-budget mb:  GPU memory kept for beamformed frames (default: 1/"));
+	stream_append_u64(&s, BEAMFORMER_FRAME_CACHE_MEMORY_SHARE);
+	stream_append_s8(&s, s8(" of GPU memory, or "));
+	stream_append_u64(&s, BEAMFORMER_FRAME_CACHE_DEFAULT_BUDGET / MB(1));
+	stream_append_s8(&s, s8(" if unknown)\n"));
+	stream_append_s8(&s, s8("    --replay study.bp:        stream a recorded study from disk into the RF slots\n"));
+	stream_append_s8(&s, s8("    --replay-rate hz:         frames per second to replay at (default: 0, as fast as possible)\n"));
+	stream_append_s8(&s, s8("    --listen address:         accept a remote client on unix:path or [ipv4]:port\n"));
+	stream_append_s8(&s, s8("    --shared-memory-size mb:  size of the region shared with clients ["));
+	stream_append_u64(&s, BEAMFORMER_SHARED_MEMORY_MIN_SIZE / MB(1));
+	stream_append_s8(&s, s8(", ...] (default: "));
+	stream_append_u64(&s, BEAMFORMER_SHARED_MEMORY_DEFAULT_SIZE / MB(1));
+	stream_append_s8(&s, s8(")\n"));
+	stream_append_s8(&s, s8("    --huge-pages:             back shared memory with huge pages if the system allows it\n"));
+	stream_append_s8(&s, s8("    --prefault:               fault in all of shared memory at startup\n"));
+	stream_append_s8(&s, s8("    --mlock:                  lock shared memory into RAM\n"));
+	os_fatal(stream_to_s8(&s));
+}
+
+function BeamformerOptions
+parse_command_line(i32 argc, char *argv[], Arena arena)
 {
+	BeamformerOptions result = {
+		.compute_workers = 1,
+		.copy_helpers    = MEMORY_COPY_DEFAULT_HELPERS,
+		.copy_threshold  = MEMORY_COPY_DEFAULT_THRESHOLD,
+
+		.shared_memory_size = BEAMFORMER_SHARED_MEMORY_DEFAULT_SIZE,
+	};
+	for (i32 i = 1; i < argc; i++) {
+		s8 arg = c_str_to_s8(argv[i]);
+		if (s8_equal(arg, s8("--compute-workers")) && i + 1 < argc) {
+			u64 count;
+			if (!parse_u64(c_str_to_s8(argv[++i]), &count) || !BETWEEN(count, 1, OS_MAX_COMPUTE_WORKERS))
+				usage(argv[0], arena);
+			result.compute_workers = (u32)count;
+		} else if (s8_equal(arg, s8("--rf-ring-depth")) && i + 1 < argc) {
+			u64 depth;
+			if (!parse_u64(c_str_to_s8(argv[++i]), &depth) || !BETWEEN(depth, 2, BEAMFORMER_RF_RING_MAX_DEPTH))
+				usage(argv[0], arena);
+			result.rf_ring_depth = (u32)depth;
+		} else if (s8_equal(arg, s8("--copy-helpers")) && i + 1 < argc) {
+			u64 count;
+			if (!parse_u64(c_str_to_s8(argv[++i]), &count) || count > MEMORY_COPY_MAX_HELPERS)
+				usage(argv[0], arena);
+			result.copy_helpers = (u32)count;
+		} else if (s8_equal(arg, s8("--copy-threshold")) && i + 1 < argc) {
+			if (!parse_u64(c_str_to_s8(argv[++i]), &result.copy_threshold))
+				usage(argv[0], arena);
+		} else if (s8_equal(arg, s8("--frame-cache-budget")) && i + 1 < argc) {
+			u64 size;
+			if (!parse_u64(c_str_to_s8(argv[++i]), &size) || size == 0)
+				usage(argv[0], arena);
+			result.frame_cache_budget = size * MB(1);
+		} else if (s8_equal(arg, s8("--replay")) && i + 1 < argc) {
+			result.replay_path = argv[++i];
+		} else if (s8_equal(arg, s8("--replay-rate")) && i + 1 < argc) {
+			if (!parse_u64(c_str_to_s8(argv[++i]), &result.replay_rate))
+				usage(argv[0], arena);
+		} else if (s8_equal(arg, s8("--listen")) && i + 1 < argc) {
+			result.listen_address = argv[++i];
+		} else if (s8_equal(arg, s8("--shared-memory-size")) && i + 1 < argc) {
+			u64 size;
+			if (!parse_u64(c_str_to_s8(argv[++i]), &size) || size < BEAMFORMER_SHARED_MEMORY_MIN_SIZE / MB(1))
+				usage(argv[0], arena);
+			result.shared_memory_size = size * MB(1);
+		} else if (s8_equal(arg, s8("--huge-pages"))) {
+			result.shared_memory_flags |= OSSharedMemoryFlags_HugePages;
+		} else if (s8_equal(arg, s8("--prefault"))) {
+			result.shared_memory_flags |= OSSharedMemoryFlags_Prefault;
+		} else if (s8_equal(arg, s8("--mlock"))) {
+			result.shared_memory_flags |= OSSharedMemoryFlags_Lock;
+		} else {
+			usage(argv[0], arena);
+		}
+	}
+	return result;
+}
+
+function void
+setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input, i32 argc, char *argv[])
+{
+	BeamformerOptions options = parse_command_line(argc, argv, *memory);
+
 	Arena  compute_arena = sub_arena(memory, MB(2),  KB(4));
 	Arena  upload_arena  = sub_arena(memory, KB(64), KB(4));
 	Stream error         = stream_alloc(memory, MB(1));
@@ -334,11 +480,13 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	input->executable_reloaded = 1;
 
 	os_init(&ctx->os, memory);
-	ctx->os.path_separator        = s8(OS_PATH_SEPARATOR);
-	ctx->os.compute_worker.arena  = compute_arena;
-	ctx->os.compute_worker.asleep = 1;
-	ctx->os.upload_worker.arena   = upload_arena;
-	ctx->os.upload_worker.asleep  = 1;
+	ctx->os.path_separator           = s8(OS_PATH_SEPARATOR);
+	ctx->os.compute_workers[0].arena = compute_arena;
+	ctx->os.compute_worker_count     = options.compute_workers;
+	ctx->os.upload_worker.arena      = upload_arena;
+	ctx->os.upload_worker.asleep     = 1;
+	for (u32 i = 0; i < ctx->os.compute_worker_count; i++)
+		ctx->os.compute_workers[i].asleep = 1;
 
 	debug_init(&ctx->os, (iptr)input, memory);
 
@@ -359,6 +507,18 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	dump_gl_params(&ctx->gl, *memory, &ctx->os);
 	validate_gl_requirements(&ctx->gl, *memory);
 
+	/* NOTE(rnp): budgets come from the total when the driver reports it. otherwise (AMD) the
+	 * memory free at startup is the best estimate of what is available to us */
+	u64 gpu_memory = KB((u64)MAX(ctx->gl.total_memory_kb, 0));
+	if (gpu_memory == 0) gpu_memory = KB((u64)MAX(ctx->gl.free_memory_kb, 0));
+
+	/* NOTE(rnp): leave the rest of the GPU for the pipeline's buffers and other programs */
+	ctx->frame_cache.budget = BEAMFORMER_FRAME_CACHE_DEFAULT_BUDGET;
+	if (gpu_memory > 0)
+		ctx->frame_cache.budget = gpu_memory / BEAMFORMER_FRAME_CACHE_MEMORY_SHARE;
+	if (options.frame_cache_budget)
+		ctx->frame_cache.budget = options.frame_cache_budget;
+
 	ctx->beamform_work_queue  = push_struct(memory, BeamformWorkQueue);
 	ctx->compute_shader_stats = push_struct(memory, ComputeShaderStats);
 	ctx->compute_timing_table = push_struct(memory, ComputeTimingTable);
@@ -366,23 +526,61 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	/* TODO(rnp): I'm not sure if its a good idea to pre-reserve a bunch of semaphores
 	 * on w32 but thats what we are doing for now */
 	u32 lock_count = (u32)BeamformerSharedMemoryLockKind_Count + (u32)BeamformerMaxParameterBlockSlots;
+	u32 shared_memory_flags = options.shared_memory_flags;
 	ctx->shared_memory = os_create_shared_memory_area(memory, OS_SHARED_MEMORY_NAME, lock_count,
-	                                                  BEAMFORMER_SHARED_MEMORY_SIZE);
+	                                                  (iz)options.shared_memory_size, &shared_memory_flags);
 	BeamformerSharedMemory *sm = ctx->shared_memory.region;
 	if (!sm) os_fatal(s8("Get more ram lol\n"));
 	mem_clear(sm, 0, sizeof(*sm));
 
+	/* NOTE(rnp): these were asked for explicitly so say so when they can't be provided */
+	if (options.shared_memory_flags != shared_memory_flags) {
+		u32 missing = options.shared_memory_flags & ~shared_memory_flags;
+		Stream s = arena_stream(*memory);
+		stream_append_s8(&s, s8("warning: shared memory:"));
+		if (missing & OSSharedMemoryFlags_HugePages) stream_append_s8(&s, s8(" huge pages unavailable;"));
+		if (missing & OSSharedMemoryFlags_Lock)      stream_append_s8(&s, s8(" couldn't lock into RAM;"));
+		stream_append_byte(&s, '\n');
+		os_write_file(ctx->os.error_handle, stream_to_s8(&s));
+	}
+
+	sm->size    = options.shared_memory_size;
 	sm->version = BEAMFORMER_SHARED_MEMORY_VERSION;
 	sm->reserved_parameter_blocks = 1;
 
 	BeamformerComputeContext *cs = &ctx->compute_context;
 
-	GLWorkerThreadContext *worker = &ctx->os.compute_worker;
-	/* TODO(rnp): we should lock this down after we have something working */
-	worker->user_context  = (iptr)ctx;
-	worker->window_handle = glfwCreateWindow(1, 1, "", 0, raylib_window_handle);
-	worker->handle        = os_create_thread(*memory, (iptr)worker, s8("[compute]"),
-	                                         compute_worker_thread_entry_point);
+	cs->rf_buffer.ring.depth      = options.rf_ring_depth ? options.rf_ring_depth : BeamformerMaxRawDataFramesInFlight;
+	cs->rf_buffer.requested_depth = options.rf_ring_depth;
+	cs->rf_buffer.memory_budget   = gpu_memory / BEAMFORMER_RF_RING_MEMORY_SHARE;
+
+	cs->worker_count = ctx->os.compute_worker_count;
+	for (u32 i = 0; i < cs->worker_count; i++) {
+		BeamformerComputeWorker *cw     = cs->workers + i;
+		GLWorkerThreadContext   *worker = ctx->os.compute_workers + i;
+		cw->thread     = worker;
+		cw->beamformer = ctx;
+		cw->index      = i;
+		/* NOTE(rnp): the first worker reads the shared queues directly */
+		if (i > 0) {
+			cw->queue     = push_struct(memory, BeamformWorkQueue);
+			worker->arena = os_alloc_arena(MB(2));
+		}
+
+		Stream name = arena_stream(*memory);
+		stream_append_s8(&name, s8("[compute"));
+		if (i > 0) {
+			stream_append_byte(&name, ' ');
+			stream_append_u64(&name, i);
+		}
+		stream_append_byte(&name, ']');
+
+		/* TODO(rnp): we should lock this down after we have something working */
+		worker->user_context  = (iptr)cw;
+		worker->window_handle = glfwCreateWindow(1, 1, "", 0, raylib_window_handle);
+		worker->handle        = os_create_thread(*memory, (iptr)worker, arena_stream_commit_zero(memory, &name),
+		                                         compute_worker_thread_entry_point);
+	}
 
 	GLWorkerThreadContext         *upload = &ctx->os.upload_worker;
 	BeamformerUploadThreadContext *upctx  = push_struct(memory, typeof(*upctx));
@@ -390,7 +588,17 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	upctx->rf_buffer     = &cs->rf_buffer;
 	upctx->shared_memory = &ctx->shared_memory;
 	upctx->compute_timing_table = ctx->compute_timing_table;
-	upctx->compute_worker_sync  = &ctx->os.compute_worker.sync_variable;
+	upctx->compute_worker_sync  = &ctx->os.compute_workers[0].sync_variable;
+	upctx->copy_engine          = push_struct(memory, MemoryCopyEngine);
+	memory_copy_engine_init(upctx->copy_engine, options.copy_helpers, options.copy_threshold);
+	for (u32 i = 0; i < upctx->copy_engine->helper_count; i++) {
+		Stream name = arena_stream(*memory);
+		stream_append_s8(&name, s8("[copy "));
+		stream_append_u64(&name, i);
+		stream_append_byte(&name, ']');
+		os_create_thread(*memory, (iptr)(upctx->copy_engine->helpers + i), arena_stream_commit_zero(memory, &name),
+		                 memory_copy_helper_entry_point);
+	}
 	upload->window_handle = glfwCreateWindow(1, 1, "", 0, raylib_window_handle);
 	upload->handle        = os_create_thread(*memory, (iptr)upload, s8("[upload]"),
 	                                         upload_worker_thread_entry_point);
@@ -450,7 +658,7 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 		os_add_file_watch(&ctx->os, memory, file, reload_shader_indirect, (iptr)src);
 		reload_shader_indirect(&ctx->os, file, (iptr)src, *memory);
 	}
-	os_wake_waiters(&worker->sync_variable);
+	os_wake_waiters(&ctx->os.compute_workers[0].sync_variable);
 
 	FrameViewRenderContext *fvr = &ctx->frame_view_render_context;
 	glCreateFramebuffers(countof(fvr->framebuffers), fvr->framebuffers);
@@ -592,6 +800,11 @@ setup_beamformer(Arena *memory, BeamformerCtx **o_ctx, BeamformerInput **o_input
 	                                               sizeof(unit_cube_vertices),
 	                                               unit_cube_indices, countof(unit_cube_indices));
 
+	if (options.replay_path)
+		beamformer_replay_start(ctx, &options, upctx->copy_engine, memory);
+	if (options.listen_address)
+		beamformer_remote_start(ctx, &options, memory);
+
 	memory->end = scratch.end;
 }
 
@@ -608,7 +821,8 @@ beamformer_invalidate_shared_memory(BeamformerCtx *ctx)
 	BeamformerSharedMemory *sm = ctx->shared_memory.region;
 	BeamformerSharedMemoryLockKind lock = BeamformerSharedMemoryLockKind_DispatchCompute;
 	atomic_store_u32(&sm->invalid, 1);
-	atomic_store_u32(&sm->external_work_queue.ridx, sm->external_work_queue.widx);
+	/* NOTE(rnp): the first compute worker is the queue's only consumer; it drains it */
+	os_wake_waiters(&ctx->os.compute_workers[0].sync_variable);
 	DEBUG_DECL(if (sm->locks[lock])) {
 		os_shared_memory_region_unlock(&ctx->shared_memory, sm->locks, (i32)lock);
 	}
@@ -0,0 +1,318 @@
+/* See LICENSE for license details. */
+/* NOTE: runs the remote server (remote.c) against the library over a loopback socket with
+ * a stand in for the beamformer which only services the shared memory queues. checks that
+ * requests made through the library land in shared memory, that RF frames arrive intact,
+ * that exports make it back and that malformed requests are rejected without touching
+ * memory they shouldn't */
+
+#define LIB_FN function
+#include "ogl_beamformer_lib.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* NOTE: just enough of the beamformer for beamformer_remote_start() */
+typedef struct {
+	SharedMemoryRegion shared_memory;
+	struct {
+		struct {i32 sync_variable;} upload_worker, compute_workers[1];
+	} os;
+} BeamformerCtx;
+
+typedef struct {
+	char *listen_address;
+} BeamformerOptions;
+
+#include "../remote.c"
+
+#if OS_LINUX
+  #define LOOPBACK_SHARED_MEMORY_NAME "/ogl_beamformer_loopback"
+#else
+  #define LOOPBACK_SHARED_MEMORY_NAME "Local\\ogl_beamformer_loopback"
+#endif
+
+#define LOOPBACK_FRAME_COUNT (8)
+
+typedef struct {
+	SharedMemoryRegion *shared_memory;
+	i32 compute_count;
+	i32 frame_count;
+	i32 bad_frame_count;
+	i32 export_count;
+} StubBeamformer;
+
+global u32 g_failures;
+
+#define check(cond) check_(cond, #cond, __LINE__)
+function b32
+check_(b32 condition, char *expression, i32 line)
+{
+	if (!condition) {
+		fprintf(stderr, "%d: check failed: %s (lib: %s)\n", line, expression,
+		        beamformer_get_last_error_string());
+		g_failures++;
+	}
+	return condition;
+}
+
+function void
+sleep_ms(u32 ms)
+{
+	/* NOTE: nothing ever wakes this */
+	i32 never = 0;
+	os_wait_on_value(&never, 0, ms);
+}
+
+function u32
+frame_size_for_index(u32 index)
+{
+	/* NOTE: odd frames are small enough to be sent in the same packet as their header */
+	u32 result = (index & 1) ? KB(1) : MB(1);
+	return result;
+}
+
+function u8
+frame_byte(u32 index, u32 byte)
+{
+	u8 result = (u8)(byte * 7 + index);
+	return result;
+}
+
+function OS_THREAD_ENTRY_POINT_FN(stub_beamformer_entry_point)
+{
+	StubBeamformer         *stub = (StubBeamformer *)_ctx;
+	BeamformerSharedMemory *sm   = stub->shared_memory->region;
+	for (;;) {
+		BeamformWork *work = beamform_work_queue_pop(&sm->external_work_queue);
+		if (work) {
+			switch (work->kind) {
+			case BeamformerWorkKind_ComputeIndirect:{
+				atomic_add_u32(&stub->compute_count, 1);
+			}break;
+			case BeamformerWorkKind_ExportBuffer:{
+				u8 *scratch = beamformer_shared_memory_scratch_arena(sm).beg;
+				for (u32 i = 0; i < work->export_context.size; i++)
+					scratch[i] = (u8)i;
+				atomic_add_u32(&stub->export_count, 1);
+				post_sync_barrier(stub->shared_memory, BeamformerSharedMemoryLockKind_ExportSync, sm->locks);
+			}break;
+			default:{}break;
+			}
+			beamform_work_queue_pop_commit(&sm->external_work_queue);
+		}
+
+		u32 index = atomic_load_u32(&sm->rf_slot_read_index);
+		BeamformerRFSlot *slot = sm->rf_slots + index % BEAMFORMER_RF_SLOT_COUNT;
+		if (atomic_load_u32(&slot->state) == BeamformerRFSlotState_Ready) {
+			u32 frame = (u32)atomic_load_u32(&stub->frame_count);
+			u8 *data  = beamformer_rf_slot_data(sm, index % BEAMFORMER_RF_SLOT_COUNT);
+			b32 good  = slot->frame_count == 1 && slot->frame_size == frame_size_for_index(frame);
+			for (u32 i = 0; good && i < slot->frame_size; i++)
+				good = data[i] == frame_byte(frame, i);
+			if (!good) atomic_add_u32(&stub->bad_frame_count, 1);
+			atomic_add_u32(&stub->frame_count, 1);
+
+			atomic_store_u32(&sm->rf_slot_read_index, index + 1);
+			os_wake_waiters(&slot->state);
+		}
+
+		if (!work) sleep_ms(1);
+	}
+
+	unreachable();
+
+	return 0;
+}
+
+function b32
+wait_for_count(i32 *count, i32 expected)
+{
+	for (u32 waited = 0; waited < 1000 && atomic_load_u32(count) < expected; waited++)
+		sleep_ms(1);
+	b32 result = atomic_load_u32(count) == expected;
+	return result;
+}
+
+/* NOTE: sends a header (and payload) straight over the socket so that the library's own
+ * checks don't get in the way. returns the reply's failed count or -1 if the server hung up */
+function i32
+raw_request(iptr handle, BeamformerRemoteHeader *header, void *payload, BeamformerRemoteHeader *next)
+{
+	i32 result = -1;
+	BeamformerRemoteHeader reply = {0};
+	if (beamformer_remote_send(handle, header, payload) &&
+	    (!next || beamformer_remote_send(handle, next, 0)) &&
+	    os_socket_receive(handle, &reply, sizeof(reply)) &&
+	    beamformer_remote_discard(handle, reply.payload_size))
+	{
+		result = (i32)reply.failed;
+	}
+	return result;
+}
+
+function iptr
+raw_connect(char *address)
+{
+	iptr result = os_socket_open(address, 0);
+	BeamformerRemoteHeader hello = {
+		.kind      = BeamformerRemoteMessageKind_Hello,
+		.arguments = {BEAMFORMER_SHARED_MEMORY_VERSION},
+	};
+	if (result == INVALID_FILE || raw_request(result, &hello, 0, 0) != 0) {
+		if (result != INVALID_FILE) os_socket_close(result);
+		result = INVALID_FILE;
+	}
+	return result;
+}
+
+function void
+test_library_requests(char *address, StubBeamformer *stub, BeamformerSharedMemory *sm)
+{
+	if (!check(beamformer_connect(address)))
+		return;
+
+	BeamformerParameters bp = {0};
+	bp.speed_of_sound = 1540;
+	check(beamformer_push_parameters(&bp));
+
+	i32 shaders[] = {BeamformerShaderKind_Decode, BeamformerShaderKind_DAS};
+	check(beamformer_push_pipeline(shaders, countof(shaders), BeamformerDataKind_Int16));
+
+	u8 *frame = malloc(MB(1));
+	for (u32 index = 0; frame && index < LOOPBACK_FRAME_COUNT; index++) {
+		u32 size = frame_size_for_index(index);
+		for (u32 i = 0; i < size; i++)
+			frame[i] = frame_byte(index, i);
+		check(beamformer_push_data_with_compute(frame, size, 0, 0));
+	}
+	free(frame);
+
+	/* NOTE: requests are applied in order so once the export is answered everything
+	 * before it has reached shared memory */
+	BeamformerComputeStatsTable *stats = malloc(sizeof(*stats));
+	if (check(stats != 0) && check(beamformer_compute_timings(stats, 1000))) {
+		b32 pattern = 1;
+		for (u32 i = 0; pattern && i < sizeof(*stats); i++)
+			pattern = ((u8 *)stats)[i] == (u8)i;
+		check(pattern);
+	}
+	free(stats);
+
+	BeamformerParameterBlock *pb = sm->published_parameter_blocks + 0;
+	check(pb->parameters.speed_of_sound == 1540);
+	check(pb->pipeline.shader_count == countof(shaders));
+	check(wait_for_count(&stub->frame_count,   LOOPBACK_FRAME_COUNT));
+	check(wait_for_count(&stub->compute_count, LOOPBACK_FRAME_COUNT));
+	check(atomic_load_u32(&stub->bad_frame_count) == 0);
+
+	beamformer_disconnect();
+}
+
+function void
+test_malformed_requests(char *address, BeamformerSharedMemory *sm)
+{
+	BeamformerRemoteHeader export = {
+		.kind      = BeamformerRemoteMessageKind_Export,
+		.arguments = {BeamformerExportKind_Stats, 16, 1000},
+	};
+
+	iptr handle = raw_connect(address);
+	if (check(handle != INVALID_FILE)) {
+		u32 region_offset = BeamformerParameterBlockRegionOffsets[BeamformerParameterBlockRegion_Parameters];
+		u32 region_size   = BeamformerParameterBlockRegionSizes[BeamformerParameterBlockRegion_Parameters];
+
+		/* NOTE: runs past the end of the region; rejected and its payload thrown away */
+		static_assert(sizeof(BeamformerParameters) <= KB(4), "payload buffer must hold the parameters region");
+		u8 payload[KB(4)] = {0};
+		BeamformerRemoteHeader upload = {
+			.kind         = BeamformerRemoteMessageKind_ParameterUpload,
+			.arguments    = {0, BeamformerParameterBlockRegion_Parameters, region_offset + 16},
+			.payload_size = region_size,
+		};
+		check(raw_request(handle, &upload, payload, &export) == 1);
+
+		/* NOTE: valid shader kinds but Demodulate can't take Float16 */
+		i32 shaders[] = {BeamformerShaderKind_Demodulate, BeamformerShaderKind_DAS};
+		BeamformerRemoteHeader pipeline = {
+			.kind         = BeamformerRemoteMessageKind_Pipeline,
+			.arguments    = {0, BeamformerDataKind_Float16},
+			.payload_size = sizeof(shaders),
+		};
+		check(raw_request(handle, &pipeline, shaders, &export) == 1);
+
+		/* NOTE: DAS can't start a pipeline */
+		pipeline.arguments[1] = BeamformerDataKind_Int16;
+		pipeline.payload_size = sizeof(i32);
+		check(raw_request(handle, &pipeline, shaders + 1, &export) == 1);
+
+		os_socket_close(handle);
+	}
+
+	/* NOTE: sizes which would wrap the bounds checks. the server must hang up instead of
+	 * receiving anything into shared memory */
+	BeamformerRemoteHeader huge[] = {
+		{
+			.kind         = BeamformerRemoteMessageKind_RFData,
+			.arguments    = {0, 1, BeamformerRFEncoding_DeltaBlocks, 1024},
+			.payload_size = 0xFFFFFFFFFFFFFFF0ull,
+		},
+		{
+			.kind         = BeamformerRemoteMessageKind_ParameterUpload,
+			.arguments    = {0, BeamformerParameterBlockRegion_Parameters,
+			                 BeamformerParameterBlockRegionOffsets[BeamformerParameterBlockRegion_Parameters]},
+			.payload_size = 0xFFFFFFFFFFFFFFF8ull,
+		},
+	};
+	for EachElement(huge, it) {
+		handle = raw_connect(address);
+		if (check(handle != INVALID_FILE)) {
+			check(raw_request(handle, huge + it, 0, &export) == -1);
+			os_socket_close(handle);
+		}
+	}
+
+	check(sm->published_parameter_blocks[0].parameters.speed_of_sound == 1540);
+	check(atomic_load_u32(&sm->rf_slot_write_index) == LOOPBACK_FRAME_COUNT);
+}
+
+extern i32
+main(i32 argc, char *argv[])
+{
+	char *address = argc > 1 ? argv[1] : "127.0.0.1:7291";
+
+	Arena arena = os_alloc_arena(MB(1));
+	u32   flags = 0;
+	u32   lock_count = (u32)BeamformerSharedMemoryLockKind_Count + (u32)BeamformerMaxParameterBlockSlots;
+
+	BeamformerCtx ctx = {0};
+	ctx.shared_memory = os_create_shared_memory_area(&arena, LOOPBACK_SHARED_MEMORY_NAME, lock_count,
+	                                                 (iz)BEAMFORMER_SHARED_MEMORY_MIN_SIZE, &flags);
+	BeamformerSharedMemory *sm = ctx.shared_memory.region;
+	if (!sm) {
+		fprintf(stderr, "failed to create shared memory\n");
+		return 1;
+	}
+	mem_clear(sm, 0, sizeof(*sm));
+	sm->size    = BEAMFORMER_SHARED_MEMORY_MIN_SIZE;
+	sm->version = BEAMFORMER_SHARED_MEMORY_VERSION;
+	sm->reserved_parameter_blocks = 1;
+
+	StubBeamformer *stub = push_struct(&arena, StubBeamformer);
+	stub->shared_memory  = &ctx.shared_memory;
+	os_create_thread(arena, (iptr)stub, s8("[stub]"), stub_beamformer_entry_point);
+
+	BeamformerOptions options = {.listen_address = address};
+	beamformer_remote_start(&ctx, &options, &arena);
+
+	test_library_requests(address, stub, sm);
+	test_malformed_requests(address, sm);
+
+	#if OS_LINUX
+	shm_unlink(LOOPBACK_SHARED_MEMORY_NAME);
+	#endif
+
+	if (g_failures) fprintf(stderr, "remote loopback (%s): %u checks failed\n", address, g_failures);
+	else            fprintf(stderr, "remote loopback (%s): ok\n", address);
+
+	return g_failures != 0;
+}
@@ -22,7 +22,9 @@ global f32 g_f_number         = 0.5f;
 typedef struct {
 	b32 loop;
 	b32 cuda;
+	b32 async;
 	u32 frame_number;
+	char *remote;
 
 	char **remaining;
 	i32    remaining_count;
@@ -221,22 +223,16 @@ beamformer_parameters_from_zemp_bp_v1(zemp_bp_v1 *zbp, BeamformerParameters *out
 function void
 usage(char *argv0)
 {
-	die("%s [--loop] [--cuda] [--frame n] base_path study\n"
+	die("%s [--loop] [--async] [--cuda] [--frame n] [--remote address] base_path study\n"
 	    "    --loop:    reupload data forever\n"
+	    "    --async:   beamform every frame with tickets and read each one back\n"
 	    "    --cuda:    use cuda for decoding\n"
-	    "    --frame n: use frame n of the data for display\n",
+	    "    --frame n: use frame n of the data for display\n"
+	    "    --remote address: send everything over a socket to a beamformer started with\n"
+	    "                      --listen address (e.g. unix:/tmp/beamformer or 127.0.0.1:7200)\n",
 	    argv0);
 }
 
-function b32
-s8_equal(s8 a, s8 b)
-{
-	b32 result = a.len == b.len;
-	for (iz i = 0; result && i < a.len; i++)
-		result &= a.data[i] == b.data[i];
-	return result;
-}
-
 function Options
 parse_argv(i32 argc, char *argv[])
 {
@@ -251,6 +247,9 @@ parse_argv(i32 argc, char *argv[])
 		if (s8_equal(arg, s8("--loop"))) {
 			shift(argv, argc);
 			result.loop = 1;
+		} else if (s8_equal(arg, s8("--async"))) {
+			shift(argv, argc);
+			result.async = 1;
 		} else if (s8_equal(arg, s8("--cuda"))) {
 			shift(argv, argc);
 			result.cuda = 1;
@@ -260,6 +259,12 @@ parse_argv(i32 argc, char *argv[])
 				result.frame_number = (u32)atoi(*argv);
 				shift(argv, argc);
 			}
+		} else if (s8_equal(arg, s8("--remote"))) {
+			shift(argv, argc);
+			if (argc) {
+				result.remote = *argv;
+				shift(argv, argc);
+			}
 		} else if (arg.len > 0 && arg.data[0] == '-') {
 			usage(argv0);
 		} else {
@@ -410,6 +415,36 @@ execute_study(s8 study, Arena arena, Stream path, Options *options)
 
 		lip.active = 0;
 		beamformer_set_live_parameters(&lip);
+	} else if (options->async) {
+		u32 frame_size  = bp.raw_data_dimensions[0] * bp.raw_data_dimensions[1] * sizeof(*data);
+		u32 frame_count = zbp->raw_data_dim[2];
+		u64 output_size = (u64)bp.output_points[0] * (u64)bp.output_points[1] * (u64)bp.output_points[2] * sizeof(v2);
+		void *output    = malloc(output_size);
+		if (!output) die("failed to allocate output buffer\n");
+
+		/* NOTE: keep as many frames in flight as the library will hand out tickets for */
+		u32 tickets[BEAMFORMER_EXPORT_SLOT_COUNT];
+		u32 submitted = 0, retrieved = 0;
+		f64 start = os_get_time();
+		while (retrieved < frame_count && !g_should_exit) {
+			if (submitted < frame_count && submitted - retrieved < countof(tickets) &&
+			    beamformer_beamform_submit((u8 *)data + (uz)submitted * frame_size, frame_size, 0,
+			                               tickets + submitted % countof(tickets)))
+			{
+				submitted++;
+			} else if (submitted == retrieved) {
+				printf("lib error: %s\n", beamformer_get_last_error_string());
+				break;
+			} else {
+				if (!beamformer_beamform_wait(tickets[retrieved % countof(tickets)], output, output_size, 0, 1000))
+					printf("lib error: %s\n", beamformer_get_last_error_string());
+				retrieved++;
+			}
+		}
+		f64 elapsed = os_get_time() - start;
+		printf("Beamformed %u frames in %8.3f [ms] | %8.3f [ms/frame]\n", retrieved,
+		       elapsed * 1e3, retrieved ? elapsed * 1e3 / retrieved : 0.0);
+		free(output);
 	} else {
 		for (u32 i = 0; i < zbp->raw_data_dim[2]; i++)
 			send_frame(data + i * bp.raw_data_dimensions[0] * bp.raw_data_dimensions[1], &bp);
@@ -437,6 +472,9 @@ main(i32 argc, char *argv[])
 
 	signal(SIGINT, sigint);
 
+	if (options.remote && !beamformer_connect(options.remote))
+		die("failed to connect to %s: %s\n", options.remote, beamformer_get_last_error_string());
+
 	Arena arena = os_alloc_arena(KB(8));
 	Stream path = stream_alloc(&arena, KB(4));
 	stream_append_s8(&path, c_str_to_s8(options.remaining[0]));
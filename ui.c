@@ -165,8 +165,7 @@ typedef struct {
 } ComputeStatsView;
 
 typedef struct {
-	b32 *processing;
-	f32 *progress;
+	BeamformerComputeContext *compute_context;
 	f32 display_t;
 	f32 display_t_velocity;
 } ComputeProgressBar;
@@ -678,6 +677,23 @@ push_das_shader_kind(Stream *s, BeamformerDASKind shader, u32 transmit_count)
 	return stream_to_s8(s);
 }
 
+/* NOTE(rnp): reports the least advanced of the workers currently processing */
+function b32
+compute_progress(BeamformerComputeContext *cc, f32 *progress)
+{
+	b32 result = 0;
+	*progress  = 1.0f;
+	for (u32 i = 0; i < cc->worker_count; i++) {
+		BeamformerComputeWorker *worker = cc->workers + i;
+		if (atomic_load_u32(&worker->processing_compute)) {
+			f32 p     = CLAMP01(worker->processing_progress);
+			*progress = result ? MIN(*progress, p) : p;
+			result    = 1;
+		}
+	}
+	return result;
+}
+
 function s8
 push_custom_view_title(Stream *s, Variable *var)
 {
@@ -688,7 +704,9 @@ push_custom_view_title(Stream *s, Variable *var)
 	}break;
 	case VT_COMPUTE_PROGRESS_BAR:{
 		stream_append_s8(s, s8("Compute Progress: "));
-		stream_append_f64(s, 100 * *var->compute_progress_bar.progress, 100);
+		f32 progress;
+		compute_progress(var->compute_progress_bar.compute_context, &progress);
+		stream_append_f64(s, 100 * progress, 100);
 		stream_append_byte(s, '%');
 	} break;
 	case VT_BEAMFORMER_FRAME_VIEW:{
@@ -1367,8 +1385,7 @@ add_compute_progress_bar(Variable *parent, BeamformerCtx *ctx)
 	result->view.child = add_variable(ui, result, &ui->arena, s8(""), 0,
 	                                  VT_COMPUTE_PROGRESS_BAR, ui->small_font);
 	ComputeProgressBar *bar = &result->view.child->compute_progress_bar;
-	bar->progress   = &ctx->compute_context.processing_progress;
-	bar->processing = &ctx->compute_context.processing_compute;
+	bar->compute_context = &ctx->compute_context;
 
 	return result;
 }
@@ -2594,8 +2611,10 @@ draw_beamformer_frame_view(BeamformerUI *ui, Arena a, Variable *var, Rect displa
 function v2
 draw_compute_progress_bar(BeamformerUI *ui, ComputeProgressBar *state, Rect r)
 {
-	if (*state->processing) state->display_t_velocity += 65.0f * dt_for_frame;
-	else                    state->display_t_velocity -= 45.0f * dt_for_frame;
+	f32 progress;
+	b32 processing = compute_progress(state->compute_context, &progress);
+	if (processing) state->display_t_velocity += 65.0f * dt_for_frame;
+	else            state->display_t_velocity -= 45.0f * dt_for_frame;
 
 	state->display_t_velocity = CLAMP(state->display_t_velocity, -10.0f, 10.0f);
 	state->display_t += state->display_t_velocity * dt_for_frame;
@@ -2605,7 +2624,7 @@ draw_compute_progress_bar(BeamformerUI *ui, ComputeProgressBar *state, Rect r)
 		Rect outline = {.pos = r.pos, .size = {{r.size.w, (f32)ui->font.baseSize}}};
 		outline      = scale_rect_centered(outline, (v2){{0.96f, 0.7f}});
 		Rect filled  = outline;
-		filled.size.w *= *state->progress;
+		filled.size.w *= progress;
 		DrawRectangleRounded(filled.rl, 2.0f, 0, fade(colour_from_normalized(HOVERED_COLOUR),
 		                                           state->display_t));
 		DrawRectangleRoundedLinesEx(outline.rl, 2.0f, 0, 3, fade(BLACK, state->display_t));
@@ -2736,6 +2755,32 @@ push_table_memory_size_row(Table *table, Arena *arena, s8 label, u64 memory_size
 		cells[2].text = s8("[B/F]");
 }
 
+function void
+push_table_count_row(Table *table, Arena *arena, s8 label, u64 count)
+{
+	TableCell *cells = table_push_row(table, arena, TRK_CELLS)->data;
+	Stream sb = arena_stream(*arena);
+	stream_append_u64(&sb, count);
+	cells[0].text = label;
+	cells[1].text = arena_stream_commit(arena, &sb);
+	cells[2].text = s8("");
+}
+
+function void
+push_table_gpu_memory_row(Table *table, Arena *arena, s8 label, u64 memory_size, u64 memory_limit)
+{
+	TableCell *cells = table_push_row(table, arena, TRK_CELLS)->data;
+	Stream sb = arena_stream(*arena);
+	stream_append_f64(&sb, (f64)memory_size / (f64)MB(1), 100);
+	if (memory_limit) {
+		stream_append_s8(&sb, s8(" / "));
+		stream_append_f64(&sb, (f64)memory_limit / (f64)MB(1), 100);
+	}
+	cells[0].text = label;
+	cells[1].text = arena_stream_commit(arena, &sb);
+	cells[2].text = s8("[MiB]");
+}
+
 function v2
 draw_compute_stats_view(BeamformerUI *ui, Arena arena, Variable *view, Rect r, v2 mouse)
 {
@@ -2785,14 +2830,45 @@ draw_compute_stats_view(BeamformerUI *ui, Arena arena, Variable *view, Rect r, v
 	u32 rf_size = ui->beamformer_context->compute_context.rf_buffer.active_rf_size;
 	push_table_time_row_with_fps(table, &arena, s8("Compute Total:"),   compute_time_sum);
 	push_table_time_row_with_fps(table, &arena, s8("RF Upload Delta:"), stats->rf_time_delta_average);
+	if (stats->table.dropped_frames)
+		push_table_count_row(table, &arena, s8("Dropped Frames:"), stats->table.dropped_frames);
+	push_table_count_row(table, &arena, s8("RF Ring Depth:"), stats->table.rf_ring_depth);
+	if (stats->table.rf_upload_sync_waits) {
+		push_table_count_row(table, &arena, s8("RF Ring Full Waits:"), stats->table.rf_upload_sync_waits);
+		push_table_time_row(table, &arena, s8("RF Ring Full Time:"), stats->table.rf_upload_sync_wait_time);
+	}
+	if (stats->table.rf_compute_sync_waits) {
+		push_table_count_row(table, &arena, s8("RF GPU Busy Waits:"), stats->table.rf_compute_sync_waits);
+		push_table_time_row(table, &arena, s8("RF GPU Busy Time:"), stats->table.rf_compute_sync_wait_time);
+	}
 	push_table_memory_size_row(table, &arena, s8("Input RF Size:"), rf_size);
 	if (rf_size != cp->rf_size)
 		push_table_memory_size_row(table, &arena, s8("DAS RF Size:"), cp->rf_size);
 
+	/* NOTE(rnp): GPU memory committed by the beamformer; read without synchronization
+	 * since it is only informational */
+	BeamformerCtx            *ctx = ui->beamformer_context;
+	BeamformerComputeContext *cc  = &ctx->compute_context;
+	u64 rf_buffer_bytes  = (u64)cc->rf_buffer.size * cc->rf_buffer.ring.depth;
+	u64 frame_bytes      = ctx->frame_cache.committed_bytes;
+	u64 interstage_bytes = 0, interstage_idle_bytes = 0;
+	for (u32 i = 0; i < cc->worker_count; i++) {
+		interstage_bytes      += cc->workers[i].interstage_pool.allocated_bytes;
+		interstage_idle_bytes += cc->workers[i].interstage_pool.free_bytes;
+	}
+	push_table_gpu_memory_row(table, &arena, s8("RF Buffer Memory:"), rf_buffer_bytes, 0);
+	push_table_gpu_memory_row(table, &arena, s8("Interstage Memory:"), interstage_bytes, 0);
+	if (interstage_idle_bytes)
+		push_table_gpu_memory_row(table, &arena, s8("Interstage Idle:"), interstage_idle_bytes, 0);
+	push_table_gpu_memory_row(table, &arena, s8("Frame Cache Memory:"), frame_bytes, ctx->frame_cache.budget);
+	push_table_gpu_memory_row(table, &arena, s8("Total GPU Memory:"),
+	                          rf_buffer_bytes + interstage_bytes + frame_bytes,
+	                          KB((u64)MAX(ctx->gl.total_memory_kb, 0)));
+
 	result = v2_add(result, table_extent(table, arena, text_spec.font));
 
 	u32 row_index = 0;
-	u32 *programs = ui->beamformer_context->compute_context.programs;
+	u32 *programs = ui->beamformer_context->compute_context.workers[0].programs;
 	TableIterator *it = table_iterator_new(table, TIK_ROWS, &arena, 0, r.pos, text_spec.font);
 	for (TableRow *row = table_iterator_next(it, &arena);
 	     row;
@@ -3970,8 +4046,11 @@ draw_ui(BeamformerCtx *ctx, BeamformerInput *input, BeamformerFrame *frame_to_dr
 	BeamformerUI *ui = ctx->ui;
 	BeamformerSharedMemory *sm = ctx->shared_memory.region;
 
-	ui->latest_plane[BeamformerViewPlaneTag_Count] = frame_to_draw;
-	ui->latest_plane[frame_plane]                  = frame_to_draw;
+	/* NOTE(rnp): frames held in latest_plane are pinned so no worker releases or reuses them */
+	beamformer_frame_cache_lock(&ctx->frame_cache);
+	beamformer_frame_repin(ui->latest_plane + BeamformerViewPlaneTag_Count, frame_to_draw);
+	beamformer_frame_repin(ui->latest_plane + frame_plane,                  frame_to_draw);
+	beamformer_frame_cache_unlock(&ctx->frame_cache);
 
 	asan_poison_region(ui->arena.beg, ui->arena.end - ui->arena.beg);
 
@@ -3999,8 +4078,8 @@ draw_ui(BeamformerCtx *ctx, BeamformerInput *input, BeamformerFrame *frame_to_dr
 			if (pb) {
 				ui->flush_params = 0;
 				mem_copy(&pb->parameters_ui, &ui->params, sizeof(ui->params));
-				mark_parameter_block_region_dirty(ctx->shared_memory.region, selected_block,
-				                                  BeamformerParameterBlockRegion_Parameters);
+				publish_parameter_block_region(ctx->shared_memory.region, selected_block,
+				                               BeamformerParameterBlockRegion_Parameters);
 				beamformer_parameter_block_unlock(&ctx->shared_memory, selected_block);
 
 				BeamformerSharedMemoryLockKind dispatch_lock = BeamformerSharedMemoryLockKind_DispatchCompute;
@@ -4010,9 +4089,9 @@ draw_ui(BeamformerCtx *ctx, BeamformerInput *input, BeamformerFrame *frame_to_dr
 					BeamformWork *work = beamform_work_queue_push(ctx->beamform_work_queue);
 					BeamformerViewPlaneTag tag = frame_to_draw ? frame_to_draw->view_plane_tag : 0;
 					if (fill_frame_compute_work(ctx, work, tag, selected_block, 0))
-						beamform_work_queue_push_commit(ctx->beamform_work_queue);
+						beamform_work_queue_push_commit(ctx->beamform_work_queue, work);
 				}
-				os_wake_waiters(&ctx->os.compute_worker.sync_variable);
+				os_wake_waiters(&ctx->os.compute_workers[0].sync_variable);
 			}
 		}
 	}
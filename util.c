@@ -437,6 +437,15 @@ arena_stream_commit_and_reset(Arena *arena, Stream *s)
 	return result;
 }
 
+function b32
+s8_equal(s8 a, s8 b)
+{
+	b32 result = a.len == b.len;
+	for (iz i = 0; result && i < a.len; i++)
+		result = a.data[i] == b.data[i];
+	return result;
+}
+
 /* NOTE(rnp): FNV-1a hash */
 function u64
 s8_hash(s8 v)
@@ -673,6 +682,54 @@ parse_f64(s8 s)
 	return result;
 }
 
+/* NOTE(rnp): only succeeds if the whole string is a base 10 number */
+function b32
+parse_u64(s8 s, u64 *result)
+{
+	b32 valid = s.len > 0;
+	u64 value = 0;
+	for (iz i = 0; valid && i < s.len; i++) {
+		u64 digit = (u64)(s.data[i] - '0');
+		/* NOTE(rnp): reject values which don't fit instead of wrapping */
+		valid = ISDIGIT(s.data[i]) && value <= (U64_MAX - digit) / 10;
+		value = value * 10 + digit;
+	}
+	if (valid) *result = value;
+	return valid;
+}
+
+function b32
+parse_socket_address(s8 s, SocketAddress *result)
+{
+	zero_struct(result);
+	b32 valid = 0;
+	if (s.len > 5 && s8_equal((s8){.data = s.data, .len = 5}, s8("unix:"))) {
+		result->path = s8_cut_head(s, 5);
+		valid = 1;
+	} else {
+		iz colon = s8_scan_backwards(s, ':');
+		u64 port;
+		valid = colon >= 0 && parse_u64(s8_cut_head(s, colon + 1), &port) && BETWEEN(port, 1, U16_MAX);
+		if (valid) {
+			result->port[0] = (u8)(port >> 8);
+			result->port[1] = (u8)(port >> 0);
+
+			s8 host = {.data = s.data, .len = colon};
+			if (s8_equal(host, s8("localhost"))) host = s8("127.0.0.1");
+			for (u32 i = 0; valid && host.len > 0 && i < countof(result->ipv4); i++) {
+				iz end = 0;
+				while (end < host.len && host.data[end] != '.') end++;
+				u64 octet;
+				valid = parse_u64((s8){.data = host.data, .len = end}, &octet) && octet <= 255 &&
+				        (i == countof(result->ipv4) - 1 ? end == host.len : end < host.len);
+				result->ipv4[i] = (u8)octet;
+				host = s8_cut_head(host, MIN(end + 1, host.len));
+			}
+		}
+	}
+	return valid;
+}
+
 function FileWatchDirectory *
 lookup_file_watch_directory(FileWatchContext *ctx, u64 hash)
 {
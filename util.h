@@ -134,6 +134,7 @@
 #define I32_MAX          (0x7FFFFFFFL)
 #define U16_MAX          (0x0000FFFFUL)
 #define U32_MAX          (0xFFFFFFFFUL)
+#define U64_MAX          (0xFFFFFFFFFFFFFFFFULL)
 #define F32_INFINITY     (1e+300*1e+300)
 #define F32_EPSILON      (1e-6f)
 #ifndef PI
@@ -264,6 +265,9 @@ typedef struct {
 
 typedef struct OS OS;
 
+/* NOTE: upper limit on the number of GL contexts running compute work */
+#define OS_MAX_COMPUTE_WORKERS 8
+
 typedef struct {
 	Arena arena;
 	iptr  handle;
@@ -306,6 +310,22 @@ typedef struct {
 	iptr  os_context;
 } SharedMemoryRegion;
 
+/* NOTE(rnp): requested when creating a shared memory region; the platform clears the
+ * flags it was unable to honour */
+typedef enum {
+	OSSharedMemoryFlags_HugePages = 1 << 0,
+	OSSharedMemoryFlags_Prefault  = 1 << 1,
+	OSSharedMemoryFlags_Lock      = 1 << 2,
+} OSSharedMemoryFlags;
+
+/* NOTE(rnp): "unix:<path>" names a unix domain socket; anything else is "[ipv4]:port".
+ * an empty host listens on every interface. ipv4 and port are in network byte order */
+typedef struct {
+	s8 path;
+	u8 ipv4[4];
+	u8 port[2];
+} SocketAddress;
+
 #define OS_ALLOC_ARENA_FN(name) Arena name(iz capacity)
 typedef OS_ALLOC_ARENA_FN(os_alloc_arena_fn);
 
@@ -360,7 +380,9 @@ struct OS {
 	iptr             error_handle;
 	s8               path_separator;
 
-	GLWorkerThreadContext compute_worker;
+	/* NOTE: compute_workers[0] also hands work off to the others */
+	GLWorkerThreadContext compute_workers[OS_MAX_COMPUTE_WORKERS];
+	u32                   compute_worker_count;
 	GLWorkerThreadContext upload_worker;
 
 	DEBUG_DECL(renderdoc_start_frame_capture_fn *start_frame_capture;)